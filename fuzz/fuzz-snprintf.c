@@ -0,0 +1,441 @@
+// Copyright (C) 2019 Miroslaw Toton, mirtoto@gmail.com
+/**
+ * Differential fuzzing of snprintf() against snprintf() of C library.
+ *
+ * Input bytes are decoded into format with one conversion (random flags,
+ * width, precision, length and conversion, '*' for width and precision),
+ * its arguments and size of output buffer. Output and return value must
+ * be the same as of C library (truncated output returns amount of put
+ * characters, 0 size returns -1), also with NULL buffer, with buffer of
+ * exact size (allocated, so overflow is caught by AddressSanitizer) and
+ * with the same arguments given by snprintf_args().
+ *
+ * Build it with libFuzzer (or AFL++ in libFuzzer mode):
+ *   clang -fsanitize=fuzzer,address,undefined -DSNPRINTF_LIBFUZZER ...
+ * Otherwise main() is standalone randomized driver, which also replays
+ * files given as arguments (crashes of libFuzzer, inputs of afl-fuzz @@):
+ *   fuzz-snprintf [-n iterations] [-s seed] [file ...]
+ *
+ * Conversions are limited to those of C library and to behavior defined
+ * by C standard. Floating point numbers are limited to 17 significant
+ * digits (MAX_DOUBLE_DIGITS), more digits are zeros by design.
+ */
+#define SNPRINTF_HEADER_ONLY
+#include "snprintf.h"
+/* implementation under test is snprintf_inline_*(), these are from libc */
+#undef snprintf
+#undef vsnprintf
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** Size of output buffers (larger than any generated output). */
+#define OUTPUT_SIZE 1024
+
+/** Input bytes of one case and position of the next unused one. */
+struct INPUT {
+	const uint8_t *data;
+	size_t size;
+	size_t pos;
+};
+
+/** Type of argument of conversion. */
+enum TYPE { TYPE_INT, TYPE_LONG, TYPE_LONG_LONG, TYPE_DOUBLE, TYPE_STRING,
+	TYPE_POINTER };
+
+/** Generated case - format, its arguments and size of output buffer. */
+struct CASE {
+	char format[64];
+	int stars;					/**< amount of '*' arguments before value */
+	int star[2];				/**< values of '*' arguments */
+	enum TYPE type;				/**< type of value */
+	long long i;				/**< integer value */
+	double d;					/**< floating point value */
+	char s[48];					/**< string value */
+	void *p;					/**< pointer value */
+	int tail;					/**< value of trailing "%d" conversion */
+	size_t size;				/**< size of truncated output buffer */
+};
+
+
+/** Take the next byte of @p in (0 when all are used). */
+static unsigned int take(struct INPUT *in) {
+	return in->pos < in->size ? in->data[in->pos++] : 0;
+}
+
+/** Take the next 8 bytes of @p in as 64-bit number. */
+static uint64_t take_64(struct INPUT *in) {
+	uint64_t v = 0;
+	for (int i = 0; i < 8; i++) {
+		v = v << 8 | take(in);
+	}
+	return v;
+}
+
+/** Integer which is often one of edge values. */
+static long long take_integer(struct INPUT *in) {
+	static const long long edges[] = {
+		0, 1, -1, 7, 10, 99, 100, 255, 256, 32767, -32768, 65535,
+		2147483647, -2147483647 - 1, 4294967295LL, 9223372036854775807LL,
+		-9223372036854775807LL - 1
+	};
+	unsigned int kind = take(in);
+	uint64_t v = take_64(in);
+	if (kind % 4 == 0) {
+		return edges[v % (sizeof(edges) / sizeof(*edges))];
+	}
+	if (kind % 4 == 1) { /* a few digits */
+		return (long long)(v % 200001) - 100000;
+	}
+	return (long long)v;
+}
+
+/** Floating point number which is often "round" or halfway one. */
+static double take_double(struct INPUT *in) {
+	static const double edges[] = {
+		0.0, -0.0, 1.0, 0.5, 2.5, 0.125, 1e16, 9.5, 99.95, 1e-5,
+		1.7976931348623157e308, 2.2250738585072014e-308,
+		4.9406564584124654e-324
+	};
+	unsigned int kind = take(in);
+	uint64_t v = take_64(in);
+	double d;
+	switch (kind % 5) {
+		case 0:
+			return edges[v % (sizeof(edges) / sizeof(*edges))] *
+				(kind & 0x80 ? -1 : 1);
+		case 1: /* halfway cases of decimal digits */
+			return (double)((long long)(v % 2000001) - 1000000) / (1 << (v >> 60));
+		case 2: /* infinity and not a number */
+			return v & 1 ? (v & 2 ? -1.0 : 1.0) / 0.0 : 0.0 / 0.0;
+		default:
+			memcpy(&d, &v, sizeof(d));
+			return d;
+	}
+}
+
+/** Decimal exponent of @p d rounded to @p digits significant digits. */
+static int decimal_exponent(double d, int digits) {
+	char e[32];
+	snprintf(e, sizeof(e), "%.*e", digits - 1, d);
+	return atoi(strchr(e, 'e') + 1);
+}
+
+/**
+ * Decode @p in into @p c case.
+ *
+ * @return 0 on success, -1 if case is not generated (defined behavior).
+ */
+static int decode(struct INPUT *in, struct CASE *c) {
+	static const char conversion_chars[] = "diuoxXcspfFeEgGaA%";
+	static const char *const lengths[] = { "", "hh", "h", "l", "ll" };
+	static const char literals[] = "x =[]";
+	char spec[32];
+	size_t n = 0;
+	unsigned int flags = take(in), conv_index = take(in) % (sizeof(conversion_chars) - 1);
+	char conv = conversion_chars[conv_index];
+	int is_integer = strchr("diuoxX", conv) != NULL;
+	int is_float = strchr("fFeEgGaA", conv) != NULL;
+	unsigned int width = take(in), precision = take(in), length = take(in) % 5;
+	int has_precision = precision % 3 != 0 && conv != 'c' && conv != 'p';
+
+	memset(c, 0, sizeof(*c));
+
+	/* flags (undefined ones are left out) */
+	spec[n++] = '%';
+	if (flags & 1) {
+		spec[n++] = '-';
+	}
+	if (conv != 'c' && conv != 's' && conv != 'p') {
+		if (flags & 2) {
+			spec[n++] = '+';
+		}
+		if (flags & 4) {
+			spec[n++] = ' ';
+		}
+		if (flags & 8 && conv != 'd' && conv != 'i' && conv != 'u') {
+			spec[n++] = '#';
+		}
+		if (flags & 16) {
+			spec[n++] = '0';
+		}
+	}
+
+	/* width */
+	if (width % 3 == 1) {
+		n += (size_t)sprintf(spec + n, "%u", width % 50);
+	} else if (width % 3 == 2) {
+		spec[n++] = '*';
+		c->star[c->stars++] = (int)(take(in) % 101) - 50;
+	}
+
+	/* precision */
+	if (has_precision && precision % 3 == 1) {
+		n += (size_t)sprintf(spec + n, ".%u", precision % 40);
+	} else if (has_precision) {
+		n += (size_t)sprintf(spec + n, ".*");
+		c->star[c->stars++] = (int)(take(in) % 46) - 5;
+	}
+
+	/* length and value */
+	if (is_integer) {
+		n += (size_t)sprintf(spec + n, "%s", lengths[length]);
+		c->type = length == 3 ? TYPE_LONG : length == 4 ? TYPE_LONG_LONG : TYPE_INT;
+		c->i = take_integer(in);
+	} else if (is_float) {
+		c->type = TYPE_DOUBLE;
+		c->d = take_double(in);
+	} else if (conv == 'c') {
+		c->type = TYPE_INT;
+		c->i = (long long)take(in);
+	} else if (conv == 's') {
+		size_t len = take(in) % (sizeof(c->s) - 1);
+		c->type = TYPE_STRING;
+		for (size_t i = 0; i < len; i++) {
+			c->s[i] = (char)(' ' + take(in) % 95);
+		}
+	} else if (conv == 'p') {
+		c->type = TYPE_POINTER;
+		c->p = (void *)(uintptr_t)(take(in) & 1 ? take_64(in) : 0);
+	} else { /* "%%" takes no argument and nothing else is defined for it */
+		if (n != 1 || c->stars != 0) {
+			return -1;
+		}
+		c->type = TYPE_INT; /* formatted by the trailing "%d" */
+	}
+	spec[n++] = conv;
+	spec[n] = '\0';
+
+	/* at most 17 significant digits of floating point number */
+	if (is_float && conv != 'a' && conv != 'A' && c->d == c->d &&
+			c->d - c->d == 0.0) {
+		int *star = has_precision && precision % 3 != 1 ? &c->star[c->stars - 1] : NULL;
+		int p = star != NULL ? *star : has_precision ? (int)(precision % 40) : 6;
+		int e = decimal_exponent(c->d, 17), limit;
+		p = p < 0 ? 6 : p;
+		limit = conv == 'f' || conv == 'F' ? 15 - e : conv == 'e' || conv == 'E' ? 16 : 17;
+		if (limit < 0 || (p > limit && star == NULL)) {
+			return -1;
+		}
+		if (p > limit) {
+			*star = p = limit;
+		}
+		/* glibc puts one digit less by "%#g" if rounding carries to the
+		 * next power of 10 (99.95 by "%#.2g" is "1.e+02") */
+		if ((conv == 'g' || conv == 'G') && (flags & 8) &&
+				decimal_exponent(c->d, p == 0 ? 1 : p) != e) {
+			return -1;
+		}
+	}
+
+	snprintf(c->format, sizeof(c->format), "%c%s%c %%d", literals[take(in) % 5],
+		spec, literals[take(in) % 5]);
+	c->tail = (int)take_integer(in);
+	c->size = take(in) % 72;
+	return 0;
+}
+
+/** Print @p c case which failed because of @p what and abort. */
+static void fail(const struct CASE *c, const char *what, const char *expected,
+		int expected_ret, const char *actual, int actual_ret) {
+	fprintf(stderr, "mismatch (%s): format \"%s\", stars %d %d, size %zu\n",
+		what, c->format, c->star[0], c->star[1], c->size);
+	fprintf(stderr, "  arguments: i %lld, d %a, s \"%s\", p %p, tail %d\n",
+		c->i, c->d, c->s, c->p, c->tail);
+	fprintf(stderr, "  expected %d \"%s\"\n  actual   %d \"%s\"\n",
+		expected_ret, expected, actual_ret, actual);
+	abort();
+}
+
+/** Compare output of @p c case with output of C library. */
+static void compare(const struct CASE *c, ...) {
+	char expected[OUTPUT_SIZE], actual[OUTPUT_SIZE];
+	struct snprintf_arg args[4];
+	size_t count = 0;
+	va_list ap;
+
+	va_start(ap, c);
+	int expected_ret = vsnprintf(expected, sizeof(expected), c->format, ap);
+	va_end(ap);
+	if (expected_ret < 0 || expected_ret >= OUTPUT_SIZE) {
+		return; /* encoding error or too long for comparison */
+	}
+
+	/* whole output */
+	va_start(ap, c);
+	int ret = snprintf_inline_vsnprintf(actual, sizeof(actual), c->format, ap);
+	va_end(ap);
+	if (ret != expected_ret || memcmp(actual, expected, (size_t)ret + 1) != 0) {
+		fail(c, "output", expected, expected_ret, actual, ret);
+	}
+
+	/* size only */
+	va_start(ap, c);
+	ret = snprintf_inline_vsnprintf(NULL, 0, c->format, ap);
+	va_end(ap);
+	if (ret != expected_ret) {
+		fail(c, "NULL buffer", expected, expected_ret, "", ret);
+	}
+
+	/* truncated output in buffer of exact size */
+	char *buffer = malloc(c->size + 1);
+	memset(buffer, '#', c->size + 1);
+	va_start(ap, c);
+	ret = snprintf_inline_vsnprintf(buffer, c->size, c->format, ap);
+	va_end(ap);
+	int truncated_ret = c->size == 0 ? -1 :
+		expected_ret < (int)c->size ? expected_ret : (int)c->size - 1;
+	if (ret != truncated_ret || (ret >= 0 &&
+			(memcmp(buffer, expected, (size_t)ret) != 0 || buffer[ret] != '\0')) ||
+			buffer[c->size] != '#') {
+		buffer[c->size] = '\0';
+		fail(c, "truncated output", expected, truncated_ret, buffer, ret);
+	}
+	free(buffer);
+
+	/* the same arguments from array of tagged values */
+	for (int i = 0; i < c->stars; i++) {
+		args[count].type = SNPRINTF_ARG_INT;
+		args[count++].value.i = c->star[i];
+	}
+	if (strstr(c->format, "%%") == NULL) {
+		switch (c->type) {
+			case TYPE_DOUBLE:
+				args[count].type = SNPRINTF_ARG_DOUBLE;
+				args[count++].value.d = c->d;
+				break;
+			case TYPE_STRING:
+				args[count].type = SNPRINTF_ARG_POINTER;
+				args[count++].value.p = (void *)(uintptr_t)c->s;
+				break;
+			case TYPE_POINTER:
+				args[count].type = SNPRINTF_ARG_POINTER;
+				args[count++].value.p = c->p;
+				break;
+			default:
+				args[count].type = SNPRINTF_ARG_INT;
+				args[count++].value.i = c->i;
+				break;
+		}
+	}
+	args[count].type = SNPRINTF_ARG_INT;
+	args[count++].value.i = c->tail;
+	ret = snprintf_args(actual, sizeof(actual), c->format, args, count);
+	if (ret != expected_ret || memcmp(actual, expected, (size_t)ret + 1) != 0) {
+		fail(c, "snprintf_args()", expected, expected_ret, actual, ret);
+	}
+
+#ifdef SNPRINTF_CACHE
+	/* formatted and then copied from cache (format of every case is at
+	 * the same address, so results of previous cases are removed) */
+	snprintf_cache_clear();
+	for (int i = 0; i < 2; i++) {
+		ret = snprintf_cached(actual, sizeof(actual), c->format, args, count);
+		if (ret != expected_ret || memcmp(actual, expected, (size_t)ret + 1) != 0) {
+			fail(c, "snprintf_cached()", expected, expected_ret, actual, ret);
+		}
+	}
+#endif
+}
+
+/** Call compare() with arguments of @p c case (@p value of the type). */
+#define COMPARE(c, value)											\
+	((c)->stars == 0 ? compare((c), value, (c)->tail) :				\
+	 (c)->stars == 1 ? compare((c), (c)->star[0], value, (c)->tail) :	\
+	 compare((c), (c)->star[0], (c)->star[1], value, (c)->tail))
+
+/** Check one case decoded from @p data of @p size bytes. */
+static void check(const uint8_t *data, size_t size) {
+	struct INPUT in = { data, size, 0 };
+	struct CASE c;
+
+	if (decode(&in, &c) != 0) {
+		return;
+	}
+
+	if (strstr(c.format, "%%") != NULL) {
+		compare(&c, c.tail);
+		return;
+	}
+
+	switch (c.type) {
+		case TYPE_INT:
+			COMPARE(&c, (int)c.i);
+			break;
+		case TYPE_LONG:
+			COMPARE(&c, (long)c.i);
+			break;
+		case TYPE_LONG_LONG:
+			COMPARE(&c, c.i);
+			break;
+		case TYPE_DOUBLE:
+			COMPARE(&c, c.d);
+			break;
+		case TYPE_STRING:
+			COMPARE(&c, c.s);
+			break;
+		case TYPE_POINTER:
+			COMPARE(&c, c.p);
+			break;
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	check(data, size);
+	return 0;
+}
+
+#ifndef SNPRINTF_LIBFUZZER
+/** Check case of the whole @p path file. */
+static int replay(const char *path) {
+	uint8_t data[4096];
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) {
+		perror(path);
+		return 1;
+	}
+	size_t size = fread(data, 1, sizeof(data), f);
+	fclose(f);
+	check(data, size);
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	unsigned long long iterations = 1000000, seed = 88172645463325252ULL;
+	int files = 0, rval = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			iterations = strtoull(argv[++i], NULL, 0);
+		} else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			seed = strtoull(argv[++i], NULL, 0) | 1;
+		} else {
+			rval |= replay(argv[i]);
+			files++;
+		}
+	}
+	if (files > 0) {
+		return rval;
+	}
+
+	/* random inputs from xorshift generator */
+	for (unsigned long long n = 0; n < iterations; n++) {
+		uint8_t data[64];
+		for (size_t i = 0; i < sizeof(data); i++) {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			data[i] = (uint8_t)seed;
+		}
+		check(data, sizeof(data));
+	}
+	printf("%llu random cases are the same as C library\n", iterations);
+
+	return 0;
+}
+#endif
@@ -12,8 +12,40 @@ extern "C" {
 #endif
 
 
+#ifdef SNPRINTF_HEADER_ONLY
+/**
+ * Header-only mode - define SNPRINTF_HEADER_ONLY before including this header
+ * to get the whole implementation as static inline functions in the current
+ * translation unit (no need to build and link src/snprintf.c). Compiler can
+ * then inline vsnprintf() into callers and fold parsing of literal formats.
+ *
+ * Functions are renamed, so they do not clash with declarations of C library.
+ * Path to implementation could be changed by SNPRINTF_SOURCE.
+ *
+ * Memory-mapped file sink (struct mmap_sink) needs POSIX declarations, which
+ * strict ISO C (e.g. -std=c99) hides. There it is left out, unless
+ * _POSIX_C_SOURCE (or _XOPEN_SOURCE, ...) is defined before this header.
+ *
+ * Implementation is C (designated initializers of tables), so this mode is
+ * not for C++ - there link src/snprintf.c compiled as C.
+ */
+#ifdef __cplusplus
+#error "SNPRINTF_HEADER_ONLY is not supported in C++, link src/snprintf.c compiled as C"
+#endif
+#define SNPRINTF_API static inline
+#define vsnprintf snprintf_inline_vsnprintf
+#define snprintf snprintf_inline_snprintf
+#ifndef SNPRINTF_SOURCE
+#define SNPRINTF_SOURCE "../src/snprintf.c"
+#endif
+#else
+/** Linkage of implemented functions. */
+#define SNPRINTF_API
+#endif
+
+
 /** @see snprintf() */
-int vsnprintf(char *string, size_t length, const char *format, va_list args) __attribute__((format(printf, 3, 0)));
+SNPRINTF_API int vsnprintf(char *string, size_t length, const char *format, va_list args) __attribute__((format(printf, 3, 0)));
 
 /**
  * Implementation of snprintf() function which create @p string of maximum
@@ -27,11 +59,25 @@ int vsnprintf(char *string, size_t length, const char *format, va_list args) __a
  *  u       | unsigned decimal integer
  *  o       | unsigned octal integer
  *  x       | unsigned hexadecimal integer
+ *  b / B   | unsigned binary integer
  *  f / F   | decimal floating point
  *  e / E   | scientific (exponential) floating point
  *  g / G   | scientific or decimal floating point
+ *  a / A   | hexadecimal floating point
+ *  k / K   | signed / unsigned binary fixed point (int fraction bits, integer)
+ *  r / R   | signed / unsigned decimal fixed point (int fraction digits, integer)
  *  c       | character
  *  s       | string
+ *  S       | string given by pointer and size_t length
+ *  V<conv> | array (pointer, size_t count, separator) of conv
+ *  J       | string escaped for JSON (precision limits input)
+ *  Q       | string quoted and escaped for logfmt if needed
+ *  H       | bytes (pointer, size_t length) as hex, .N groups by N
+ *  T       | long long ns since epoch as ISO-8601 UTC, .N digits
+ *  I4, I   | IPv4 address from unsigned int (host order)
+ *  I6      | IPv6 address (RFC 5952) from 16 bytes
+ *  M       | MAC address from 6 bytes
+ *  Z       | unsigned long long bytes as size, .N digits (3)
  *  p       | pointer
  *  %       | percent character
  * 
@@ -43,16 +89,18 @@ int vsnprintf(char *string, size_t length, const char *format, va_list args) __a
  *  h       | signed / unsigned short
  *  l       | signed / unsigned long
  *  ll      | signed / unsigned long long
+ *  w128    | signed / unsigned __int128 (if supported)
  * 
  * # Supported flags
  * 
  *   Flag   | Description
  * -------- | ----------------------------------------
  *  -       | justify left
- *  +       | justify right or put a plus if number
- *  #       | prefix 0x, 0X for hex and 0 for octal
+ *  +       | put a plus if number is not negative
+ *  #       | prefix 0x, 0X for hex and 0 for octal, 0b, 0B for %b, upper case %H %M, binary %Z
  *  *       | width and/or precision is specified as an int argument
- *  0       | for number padding with zeros instead of spaces
+ *  0       | for number padding with zeros instead of spaces (ignored with -)
+ *  '       | group thousands of %d, %i, %u by ',', %b by 4 with '_'
  *  (space) | leave a blank for number with no sign
  * 
  * @param string Output buffer.
@@ -63,7 +111,425 @@ int vsnprintf(char *string, size_t length, const char *format, va_list args) __a
  * @retval >=0 Amount of characters put in @p string.
  * @retval  -1 Output buffer size is too small.
  */
-int snprintf(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * Fast paths of snprintf() for the most common literal formats (the format
+ * is given in the name: snprintf_fast_s_eq_d() is for "%s=%d"). They give
+ * the same results like snprintf() but skip parsing of @p format which must
+ * be exactly the one of function. Do not call them directly, snprintf() is
+ * routed to them at compile time (@see SNPRINTF_FAST_PATH).
+ */
+SNPRINTF_API int snprintf_fast_d(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_u(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_ld(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_lu(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_lld(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_llu(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_x(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_08x(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_s(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+SNPRINTF_API int snprintf_fast_s_eq_d(char *string, size_t length, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+
+/** Type of snprintf_arg - signed integer (snprintf_arg::value::i). */
+#define SNPRINTF_ARG_INT      0
+/** Type of snprintf_arg - unsigned integer (snprintf_arg::value::u). */
+#define SNPRINTF_ARG_UINT     1
+/** Type of snprintf_arg - floating point number (snprintf_arg::value::d). */
+#define SNPRINTF_ARG_DOUBLE   2
+/** Type of snprintf_arg - pointer or '\0' terminated string (snprintf_arg::value::p). */
+#define SNPRINTF_ARG_POINTER  3
+/** Type of snprintf_arg - string given by pointer and length (snprintf_arg::value::s). */
+#define SNPRINTF_ARG_STRING   4
+
+/**
+ * Tagged argument of snprintf_args() - value together with its type, so
+ * arguments could be built at run time (bindings to other languages) or
+ * stored and formatted later.
+ */
+struct snprintf_arg {
+  int type;                   /**< type of value (SNPRINTF_ARG_*) */
+  union {
+    long long i;              /**< signed integer */
+    unsigned long long u;     /**< unsigned integer */
+    double d;                 /**< floating point number */
+    void *p;                  /**< pointer */
+    struct {
+      const char *str;        /**< characters (not terminated by '\0') */
+      size_t len;             /**< amount of characters */
+    } s;                      /**< string given by pointer and length */
+  } value;                    /**< value of argument */
+};
+
+/**
+ * Implementation of snprintf() which takes arguments from @p args array
+ * of tagged values instead of variable arguments. Every conversion takes
+ * one entry of @p args (also those which take two arguments like %S and %H
+ * when they get SNPRINTF_ARG_STRING). Value of other type than expected by
+ * conversion is converted to it (like by cast) and missing arguments are 0.
+ * The same @p args could be formatted any number of times.
+ *
+ * @param string Output buffer or NULL to calculate only size.
+ * @param length Size of output buffer @p string.
+ * @param format Format of input parameters (@see snprintf()).
+ * @param args Array of tagged arguments.
+ * @param count Amount of entries in @p args.
+ *
+ * @retval >=0 Amount of characters put in @p string.
+ * @retval  -1 Output buffer size is too small.
+ */
+SNPRINTF_API int snprintf_args(char *string, size_t length, const char *format, const struct snprintf_arg *args, size_t count);
+
+/**
+ * Get types of arguments expected by @p format, so array of tagged
+ * arguments for snprintf_args() could be built (or checked) only once
+ * for the format.
+ *
+ * @param format Format of input parameters (@see snprintf()).
+ * @param types Output array of SNPRINTF_ARG_* types (could be NULL).
+ * @param size Size of @p types array.
+ *
+ * @return Amount of arguments expected by @p format (also when it is
+ *         more than @p size).
+ */
+SNPRINTF_API int snprintf_signature(const char *format, int *types, size_t size);
+
+
+#ifndef SNPRINTF_NO_CACHE
+/** Cache of results of snprintf_cached() is available. */
+#define SNPRINTF_CACHE
+
+/** Counters of cache of snprintf_cached() of calling thread. */
+struct snprintf_cache_stats {
+  unsigned long hits;         /**< results taken from cache */
+  unsigned long misses;       /**< results formatted and put in cache */
+  unsigned long evictions;    /**< results removed from cache for new ones */
+  unsigned long bypasses;     /**< results which could not be cached */
+};
+
+/**
+ * Implementation of snprintf_args() which keeps results in small LRU cache
+ * of calling thread, so repeated calls with the same @p format (the same
+ * pointer) and the same arguments only copy result formatted before. Key
+ * of result are values of arguments and contents of strings (%s, %J, %Q,
+ * SNPRINTF_ARG_STRING). Calls with pointers to other data (%n, %H, %M,
+ * %I6, %V, ...) and results longer than SNPRINTF_CACHE_SIZE (128 by
+ * default) are formatted without cache. Cache of every thread keeps
+ * SNPRINTF_CACHE_ENTRIES results (32 by default). It pays off for numbers
+ * (floating point, grouping, timestamps), formats which only join strings
+ * are formatted as fast as key is built. Define SNPRINTF_NO_CACHE to remove
+ * it.
+ *
+ * @see snprintf_args()
+ */
+SNPRINTF_API int snprintf_cached(char *string, size_t length, const char *format, const struct snprintf_arg *args, size_t count);
+
+/** Get counters of cache of snprintf_cached() of calling thread. */
+SNPRINTF_API void snprintf_cache_stats(struct snprintf_cache_stats *stats);
+
+/** Remove all results from cache of calling thread and reset its counters. */
+SNPRINTF_API void snprintf_cache_clear(void);
+#endif
+
+
+/**
+ * String builder which appends formatted output at the end of fixed size
+ * buffer without looking through already built string.
+ *
+ * When output does not fit into buffer then builder is marked as overflowed
+ * and all next appends only count characters which would be put. Initialize
+ * it by sb_init() and close it by sb_finish().
+ */
+struct sb {
+  char *base;                 /**< output buffer (NULL to calculate only size) */
+  size_t capacity;            /**< size of sb::base */
+  size_t position;            /**< length of built (or would be built) string */
+  int overflow;               /**< sticky flag - output did not fit in buffer */
+};
+
+/**
+ * Initialize @p sb string builder.
+ *
+ * @param sb Not NULL string builder.
+ * @param base Output buffer or NULL to calculate only size of output string.
+ * @param capacity Size of output buffer @p base.
+ */
+SNPRINTF_API void sb_init(struct sb *sb, char *base, size_t capacity);
+
+/** @see sb_printf() */
+SNPRINTF_API int sb_vprintf(struct sb *sb, const char *format, va_list args) __attribute__((format(printf, 2, 0)));
+
+/**
+ * Append formatted string to @p sb according of @p format.
+ *
+ * @param sb Not NULL string builder.
+ * @param format Format of input parameters (@see snprintf()).
+ * @param ... Input parameters according of @p format.
+ *
+ * @return Amount of characters appended (or would be appended) to @p sb.
+ */
+SNPRINTF_API int sb_printf(struct sb *sb, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Append @p c character to @p sb.
+ *
+ * @return Amount of characters appended (or would be appended) to @p sb.
+ */
+SNPRINTF_API int sb_putc(struct sb *sb, char c);
+
+/**
+ * Append @p s string to @p sb.
+ *
+ * @return Amount of characters appended (or would be appended) to @p sb.
+ */
+SNPRINTF_API int sb_puts(struct sb *sb, const char *s);
+
+/**
+ * Append @p count times @p c character to @p sb.
+ *
+ * @return Amount of characters appended (or would be appended) to @p sb.
+ */
+SNPRINTF_API int sb_pad(struct sb *sb, char c, size_t count);
+
+/**
+ * Put '\0' character at the end of string built by @p sb.
+ *
+ * @param sb Not NULL string builder.
+ *
+ * @retval >=0 Length of whole string (also when it did not fit in buffer).
+ * @retval  -1 Output buffer size is 0.
+ */
+SNPRINTF_API int sb_finish(struct sb *sb);
+
+
+/** Field of logfmt record - key and conversion of its value. */
+struct logfmt_field {
+  const char *key;            /**< key (one word without '=', '"' and '%') */
+  const char *format;         /**< one conversion of value, e.g. "%d", "%.3f" */
+};
+
+/**
+ * Compile schema of logfmt record (@p fields) into @p tmpl format
+ * string with keys already rendered: { "lvl", "%s" }, { "ms", "%.1f" }
+ * gives "lvl=%Q ms=%.1f". Record is then formatted by snprintf() (or
+ * sb_printf(), snprintf_args(), ...) with @p tmpl and only values of
+ * fields. String values (%s) are put in quotes only when they need it.
+ *
+ * @param tmpl Output buffer for format string.
+ * @param size Size of @p tmpl buffer.
+ * @param fields Array of fields of record.
+ * @param count Amount of entries in @p fields.
+ *
+ * @retval >=0 Length of @p tmpl.
+ * @retval  -1 @p tmpl is too small or key or format of field is invalid.
+ */
+SNPRINTF_API int logfmt_compile(char *tmpl, size_t size, const struct logfmt_field *fields, size_t count);
+
+
+#if !defined(SNPRINTF_NO_IOV) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/uio.h>
+
+/** Output to array of iovec entries is available (POSIX systems). */
+#define SNPRINTF_IOV
+
+/** @see snprintf_iov() */
+SNPRINTF_API int vsnprintf_iov(struct iovec *iov, int iovcnt, char *scratch, size_t size, const char *format, va_list args) __attribute__((format(printf, 5, 0)));
+
+/**
+ * Implementation of snprintf() which does not copy output into one buffer
+ * but describes it by @p iov array ready for writev(). Literal parts of
+ * @p format and strings (%s) are referenced in place, so they must be valid
+ * until output is written. Only converted numbers, characters and padding
+ * are put into @p scratch buffer.
+ *
+ * @param iov Output array of iovec entries.
+ * @param iovcnt Amount of entries in @p iov.
+ * @param scratch Buffer for converted numbers and padding.
+ * @param size Size of @p scratch buffer.
+ * @param format Format of input parameters (@see snprintf()).
+ * @param ... Input parameters according of @p format.
+ *
+ * @retval >=0 Amount of entries put in @p iov.
+ * @retval  -1 @p iov or @p scratch is too small.
+ */
+SNPRINTF_API int snprintf_iov(struct iovec *iov, int iovcnt, char *scratch, size_t size, const char *format, ...) __attribute__((format(printf, 5, 6)));
+#endif
+
+
+#if !defined(SNPRINTF_NO_MMAP) && (defined(__unix__) || defined(__APPLE__)) && \
+    (!defined(SNPRINTF_HEADER_ONLY) || !defined(__STRICT_ANSI__) || \
+     defined(_POSIX_C_SOURCE) || defined(_XOPEN_SOURCE) || \
+     defined(_GNU_SOURCE) || defined(_DEFAULT_SOURCE) || defined(__APPLE__))
+/** Output to memory-mapped file is available (POSIX systems). */
+#define SNPRINTF_MMAP
+
+/** Default size of extent by which memory-mapped file grows (64 MiB). */
+#define MMAP_SINK_EXTENT ((size_t)64 << 20)
+
+/**
+ * Sink which formats output directly into memory-mapped file, so there is
+ * no staging buffer and no system call per append. File grows (and it is
+ * mapped again) by whole extents and at the end it is truncated to exact
+ * length of output. Open it by mmap_sink_open() and close it by
+ * mmap_sink_close().
+ */
+struct mmap_sink {
+  int fd;                     /**< descriptor of output file */
+  char *base;                 /**< mapping of output file */
+  size_t mapped;              /**< size of mmap_sink::base (and file) */
+  size_t position;            /**< length of output */
+  size_t extent;              /**< size of step of growth */
+};
+
+/**
+ * Create (or truncate) @p path file and map it for output by @p ms sink.
+ *
+ * @param ms Not NULL memory-mapped file sink.
+ * @param path Path of output file.
+ * @param extent Size of step of growth of file (0 for MMAP_SINK_EXTENT).
+ *
+ * @retval  0 Success.
+ * @retval -1 File could not be created or mapped (see errno).
+ */
+SNPRINTF_API int mmap_sink_open(struct mmap_sink *ms, const char *path, size_t extent);
+
+/** @see mmap_sink_printf() */
+SNPRINTF_API int mmap_sink_vprintf(struct mmap_sink *ms, const char *format, va_list args) __attribute__((format(printf, 2, 0)));
+
+/**
+ * Append formatted string to @p ms file according of @p format.
+ *
+ * @param ms Not NULL memory-mapped file sink.
+ * @param format Format of input parameters (@see snprintf()).
+ * @param ... Input parameters according of @p format.
+ *
+ * @retval >=0 Amount of characters appended to @p ms file.
+ * @retval  -1 File could not grow (see errno).
+ */
+SNPRINTF_API int mmap_sink_printf(struct mmap_sink *ms, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Unmap @p ms file, truncate it to exact length of output and close it.
+ *
+ * @retval  0 Success.
+ * @retval -1 Some of the operations failed (see errno).
+ */
+SNPRINTF_API int mmap_sink_close(struct mmap_sink *ms);
+#endif
+
+
+#ifndef SNPRINTF_NO_SCAN
+/** Parsing of numbers (scan_ull(), scan_ll(), scan_double()) and sscan(). */
+#define SNPRINTF_SCAN
+
+/**
+ * Parse integer like strtoull(), but only from @p len characters of @p str,
+ * so digits are parsed by 8 at once without looking for '\0' character.
+ * White spaces, sign and prefix of @p base ("0x", "0b" or "0" for 0) are
+ * skipped. Negative number is negated as unsigned.
+ *
+ * @param str Input string.
+ * @param len Length of @p str (e.g. strlen()).
+ * @param end Output pointer just after number (@p str if there is none),
+ *            could be NULL.
+ * @param base Base of number (2 ... 36) or 0 to take it from prefix.
+ *
+ * @return Parsed number or ULLONG_MAX with errno set to ERANGE when it does
+ *         not fit.
+ */
+SNPRINTF_API unsigned long long scan_ull(const char *str, size_t len, const char **end, int base);
+
+/**
+ * Parse signed integer like strtoll() (@see scan_ull()).
+ *
+ * @return Parsed number or LLONG_MIN / LLONG_MAX with errno set to ERANGE
+ *         when it does not fit.
+ */
+SNPRINTF_API long long scan_ll(const char *str, size_t len, const char **end, int base);
+
+/**
+ * Parse floating point number like strtod() - decimal, hexadecimal (0x1.8p3),
+ * infinity and not a number - from @p len characters of @p str. Result is
+ * always the nearest double (rounded half to even) without math.h, also for
+ * output of %.17g and %a of snprintf(), which gives back the same number.
+ *
+ * @param str Input string.
+ * @param len Length of @p str (e.g. strlen()).
+ * @param end Output pointer just after number (@p str if there is none),
+ *            could be NULL.
+ *
+ * @return Parsed number, errno is set to ERANGE when it is rounded to
+ *         infinity or to zero.
+ */
+SNPRINTF_API double scan_double(const char *str, size_t len, const char **end);
+
+/** @see sscan() */
+SNPRINTF_API int vsscan(const char *str, const char *format, va_list args) __attribute__((format(scanf, 2, 0)));
+
+/**
+ * Subset of sscanf() built on scan_*() functions. White space in @p format
+ * matches any amount of white spaces, other characters (and %%) match
+ * themselves. Conversions: %d, %i, %u, %o, %x (with hh, h, l, ll), %a, %e,
+ * %f, %g (float or double with l), %s, %c and %n, each with optional '*'
+ * (no assignment) and width.
+ *
+ * @param str Input string.
+ * @param format Format of input (@see above).
+ * @param ... Pointers to output variables according of @p format.
+ *
+ * @retval >=0 Amount of assigned variables.
+ * @retval  -1 Input ends before the first conversion.
+ */
+SNPRINTF_API int sscan(const char *str, const char *format, ...) __attribute__((format(scanf, 2, 3)));
+#endif
+
+
+#if defined(__GNUC__) && defined(__OPTIMIZE__) && !defined(__cplusplus) && \
+    !defined(SNPRINTF_HEADER_ONLY) && !defined(SNPRINTF_NO_FAST_PATH)
+/**
+ * Fast path - snprintf() with literal format known at compile time is routed
+ * directly to specialized snprintf_fast_*() function if there is one for it,
+ * otherwise (also for not literal format) to snprintf() function. Choice is
+ * done by compiler, so there is no cost at run time. Enabled for optimized
+ * builds by GCC compatible compilers, it can be disabled by defining
+ * SNPRINTF_NO_FAST_PATH. Not for C++, where the macro would also rewrite
+ * std::snprintf() - call snprintf_fast_*() functions directly there.
+ */
+#define SNPRINTF_FAST_PATH
+
+/* declaration of snprintf() from C library must not meet the macro below */
+#if defined(__has_include)
+#if __has_include(<stdio.h>)
+#include <stdio.h>
+#endif
+#endif
+
+/** Format of snprintf() - the first of variadic arguments. */
+#define SNPRINTF_FORMAT_(format, ...) format
+
+/** Is @p format string known at compile time and equal to @p literal? */
+#define SNPRINTF_IS_(format, literal)                                   \
+  (__builtin_constant_p(format) && __builtin_strcmp((format), (literal)) == 0)
+
+/** Call fast path function @p name if format is its @p literal. */
+#define SNPRINTF_FAST_(name, literal, string, length, ...)              \
+  SNPRINTF_IS_(SNPRINTF_FORMAT_(__VA_ARGS__, 0), literal) ?             \
+    name(string, length, __VA_ARGS__) :
+
+#define snprintf(string, length, ...)                                   \
+  (SNPRINTF_FAST_(snprintf_fast_d, "%d", string, length, __VA_ARGS__)   \
+   SNPRINTF_FAST_(snprintf_fast_u, "%u", string, length, __VA_ARGS__)   \
+   SNPRINTF_FAST_(snprintf_fast_ld, "%ld", string, length, __VA_ARGS__) \
+   SNPRINTF_FAST_(snprintf_fast_lu, "%lu", string, length, __VA_ARGS__) \
+   SNPRINTF_FAST_(snprintf_fast_lld, "%lld", string, length, __VA_ARGS__) \
+   SNPRINTF_FAST_(snprintf_fast_llu, "%llu", string, length, __VA_ARGS__) \
+   SNPRINTF_FAST_(snprintf_fast_x, "%x", string, length, __VA_ARGS__)   \
+   SNPRINTF_FAST_(snprintf_fast_08x, "%08x", string, length, __VA_ARGS__) \
+   SNPRINTF_FAST_(snprintf_fast_s, "%s", string, length, __VA_ARGS__)   \
+   SNPRINTF_FAST_(snprintf_fast_s_eq_d, "%s=%d", string, length, __VA_ARGS__) \
+   snprintf(string, length, __VA_ARGS__))
+#endif
 
 
 #ifdef __cplusplus
@@ -71,4 +537,9 @@ int snprintf(char *string, size_t length, const char *format, ...) __attribute__
 #endif
 
 
+#ifdef SNPRINTF_HEADER_ONLY
+#include SNPRINTF_SOURCE
+#endif
+
+
 #endif  // SNPRINTF_H_
@@ -2,7 +2,7 @@
 
 /**
  * Unix snprintf() implementation.
- * @version 2.3
+ * @version 2.4
  *  
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,6 +20,57 @@
  * 
  * Revision History:
  * 
+ * @version 2.4
+ *  - string builder (sb_printf(), sb_putc(), sb_puts(), sb_pad())
+ *  - fixed point numbers (%k, %K, %r, %R) without floating point arithmetic
+ *  - hexadecimal floating point (%a, %A) taken directly from bit pattern
+ *  - floating point numbers are decomposed to digits and exponent only once
+ *    and rounded only once (also fix %g according to C standard)
+ *  - support for infinity and not a number
+ *  - parse conversion specification in one pass driven by table of classes
+ *    of format characters and dispatch conversions by table of functions
+ *  - output state is passed by value and flags are kept in a bitset
+ *  - fix '+' and '-' flags together, '0' flag is ignored with '-'
+ *  - header-only mode (SNPRINTF_HEADER_ONLY) and static library target
+ *  - fast path for the most common literal formats chosen at compile time
+ *  - features switches (SNPRINTF_NO_FLOAT, SNPRINTF_NO_LONGLONG,
+ *    SNPRINTF_NO_OCTAL, SNPRINTF_NO_N) to remove unused conversions
+ *  - output to array of iovec entries for writev() (snprintf_iov())
+ *  - output directly into memory-mapped file (mmap_sink_printf())
+ *  - string escaped for JSON (%J) scanned by 16 characters with SSE2
+ *  - hexadecimal dump of buffer of bytes (%H) driven by table of pairs
+ *  - ISO-8601 UTC timestamp (%T) with date prefix cached per thread
+ *  - network addresses: IPv4 (%I4), IPv6 (%I6) and MAC (%M)
+ *  - grouping of thousands of decimal integer ('\'' flag) and human
+ *    readable size (%Z) in SI or binary units
+ *  - 128-bit integers (w128 length) converted by chunks of 19 digits
+ *  - binary integer (%b, %B) expanded by 8 bits at once
+ *  - precision limits scan of %s string, string given by pointer and
+ *    length (%S)
+ *  - array of numbers or strings in one conversion (%V), two decimal
+ *    digits per division
+ *  - arguments from array of tagged values (snprintf_args()) and types of
+ *    arguments expected by format (snprintf_signature())
+ *  - logfmt value quoted only when it is needed (%Q) and logfmt record
+ *    template compiled from schema of keys and values (logfmt_compile())
+ *  - results of repeated calls with the same format and arguments kept in
+ *    per thread LRU cache (snprintf_cached())
+ *  - parsing of numbers (scan_ull(), scan_ll(), scan_double()) by 8 decimal
+ *    digits at once and by Eisel-Lemire algorithm, subset of sscanf() on
+ *    top of it (sscan())
+ *  - digits of %e, %f and %g exactly rounded by table of 128-bit powers of
+ *    5 shared with parsing of numbers
+ *  - fix signed overflow of negation of the most negative integer
+ *  - negative '*' width justifies left
+ *  - negative '*' precision is taken as not given
+ *  - '+' and ' ' flags are ignored by unsigned conversions
+ *  - sign and prefix of integer are counted in width and put before
+ *    zeros of '0' flag
+ *  - '#' flag puts no "0x" before zero
+ *  - '#' flag of %o only makes the first digit zero (also of "%#.0o" of 0)
+ *  - width (also '*') of %c and %p
+ *  - sign of not a number (-nan) by %e, %f and %g like by %a
+ * 
  * @version 2.3
  * @author Miroslaw Toton (mirtoto), mirtoto@gmail.com
  *  - support NULL as output buffer to calculate size of output string
@@ -87,11 +138,28 @@
  *  - Mike Parker (mouse)
  */
 
+#if !defined(SNPRINTF_HEADER_ONLY) && !defined(_POSIX_C_SOURCE) && \
+    (defined(__unix__) || defined(__APPLE__))
+/** ftruncate() and friends are POSIX, not ISO C (e.g. with -std=c99). */
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <ctype.h>
+#include <errno.h>
 #include <string.h>
 
 #include "snprintf.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef SNPRINTF_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 
 #ifdef __clang__
 #pragma clang diagnostic push
@@ -99,181 +167,248 @@
 #endif
 
 
+/**
+ * Output of vsnprintf()/snprintf() functions. It is passed by value and
+ * amount of characters put so far is passed to and returned from every
+ * formatting function, so the whole output state could live in registers.
+ */
+struct OUT {
+  char *ps;                   /**< output string (NULL to calculate size only) */
+  size_t size;                /**< size of OUT::ps - 1 */
+};
+
 /** 
- * This struct holds temporary data during processing @p format 
+ * This struct holds conversion specification parsed from @p format 
  * of vsnprintf()/snprintf() functions.
  */
-struct DATA {
-  size_t counter;             /**< counter of length of string in DATA::ps */
-  size_t ps_size;             /**< size of DATA::ps - 1 */
-  char *ps;                   /**< pointer to output string */
-  const char *pf;             /**< pointer to input format string */
+struct SPEC {
 
-/** Value of DATA::width - undefined width of field. */
+/** Value of SPEC::width - undefined width of field. */
 #define WIDTH_UNSET          -1
 
   int width;                  /**< width of field */
 
-/** Value of DATA::precision - undefined precision of field. */
+/** Value of SPEC::precision - undefined precision of field. */
 #define PRECISION_UNSET      -1
 
-  int precision;
-
-/** Value of DATA::align - undefined align of field. */
-#define ALIGN_UNSET           0
-/** Value of DATA::align - align right of field. */
-#define ALIGN_RIGHT           1
-/** Value of DATA::align - align left of field. */
-#define ALIGN_LEFT            2
-
-  unsigned int align:2;     /**< align of field */
-  unsigned int is_square:1; /**< is field with hash flag? */
-  unsigned int is_space:1;  /**< is field with space flag? */
-  unsigned int is_dot:1;    /**< is field with dot flag? */
-  unsigned int is_star_w:1; /**< is field with width defined? */
-  unsigned int is_star_p:1; /**< is field with precision defined? */
-
-/** Value of DATA::a_long - "int" type of input argument. */
+  int precision;              /**< precision of field */
+
+/** Flag of SPEC::flags - align left of field ('-'). */
+#define FLAG_LEFT          0x01
+/** Flag of SPEC::flags - put a plus if number is not negative ('+'). */
+#define FLAG_PLUS          0x02
+/** Flag of SPEC::flags - put a blank if number is not negative (' '). */
+#define FLAG_SPACE         0x04
+/** Flag of SPEC::flags - alternate form of field ('#'). */
+#define FLAG_SQUARE        0x08
+/** Flag of SPEC::flags - padding with zeros ('0'). */
+#define FLAG_ZERO          0x10
+/** Flag of SPEC::flags - width of field is given as argument ('*'). */
+#define FLAG_STAR_W        0x20
+/** Flag of SPEC::flags - precision of field is given as argument ('*'). */
+#define FLAG_STAR_P        0x40
+/** Flag of SPEC::flags - group thousands of decimal integer ('\''). */
+#define FLAG_QUOTE         0x80
+
+  unsigned int flags;         /**< bitset of FLAG_* flags */
+
+/** Value of SPEC::length - "int" type of input argument. */
 #define INT_LEN_DEFAULT       0
-/** Value of DATA::a_long - "long" type of input argument. */
+/** Value of SPEC::length - "long" type of input argument. */
 #define INT_LEN_LONG          1
-/** Value of DATA::a_long - "long long" of input type argument. */
+/** Value of SPEC::length - "long long" of input type argument. */
 #define INT_LEN_LONG_LONG     2
-/** Value of DATA::a_long - "short" type of input argument. */
+/** Value of SPEC::length - "short" type of input argument. */
 #define INT_LEN_SHORT         3
-/** Value of DATA::a_long - "char" type of input argument. */
+/** Value of SPEC::length - "char" type of input argument. */
 #define INT_LEN_CHAR          4
+/** Value of SPEC::length - 128-bit integer type of input argument. */
+#define INT_LEN_INT128        5
 
-  unsigned int a_long:3;    /**< type of input */
-
-  unsigned int rfu:6;       /**< RFU */
+  int length;                 /**< type of input */
 
-  char pad;                 /**< padding character */
+  char conv;                  /**< conversion character */
+  char pad;                   /**< padding character */
+  char suffix;                /**< character after conversion (%I4, %Vd) */
+};
 
-  char slop[5];             /**< RFU */
+/**
+ * Source of input arguments of conversions - variable arguments or array
+ * of tagged arguments (snprintf_args()).
+ */
+struct ARGS {
+  va_list *ap;                /**< variable arguments (NULL for ARGS::vector) */
+  const struct snprintf_arg *vector; /**< array of tagged arguments */
+  size_t size;                /**< amount of entries in ARGS::vector */
+  size_t next;                /**< index of the next entry in ARGS::vector */
 };
 
-/** Round off to the precision. */
-#define ROUND_TO_PRECISION(d, p) \
-  ((d < 0.) ? d - pow_10(-(p)->precision) * 0.5 : d + pow_10(-(p)->precision) * 0.5)
+#ifndef SNPRINTF_NO_LONGLONG
+/** The widest integer type of integer conversions. */
+#define LONGEST               long long
+/** Is input argument "long long" integer? */
+#define LONG_LONG_ARG(s)      ((s)->length == INT_LEN_LONG_LONG)
+#else
+#define LONGEST               long
+#define LONG_LONG_ARG(s)      0
+#endif
 
-/** Put a @p c character to output buffer if there is enough space. */
-#define PUT_CHAR(c, p)                                  \
-  if ((p)->counter < (p)->ps_size) {                    \
-    if ((p)->ps != NULL) {                              \
-      *(p)->ps++ = (c);                                 \
-    }                                                   \
-    (p)->counter++;                                     \
-  }
+/** Amount of bits of LONGEST integer type. */
+#define LONGEST_BITS          ((int)sizeof(LONGEST) * 8)
 
-/** Put optionally '+' character to to output buffer if there is enough space. */
-#define PUT_PLUS(d, p)                                  \
-  if ((d) > 0 && (p)->align == ALIGN_RIGHT) {           \
-    PUT_CHAR('+', p);                                   \
-  }
+#if defined(__SIZEOF_INT128__) && !defined(SNPRINTF_NO_LONGLONG)
+/** 128-bit integers (w128 length) are supported. */
+#define SNPRINTF_INT128
+/** Signed 128-bit integer type. */
+__extension__ typedef __int128 INT128;
+/** Unsigned 128-bit integer type. */
+__extension__ typedef unsigned __int128 UINT128;
+#endif
 
-/** Put optionally ' ' character to to output buffer if there is enough space. */
-#define PUT_SPACE(d, p)                                 \
-  if ((p)->is_space && (d) > 0) {                       \
-    PUT_CHAR(' ', p);                                   \
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_THREADS__)
+/** Storage class of variables local for thread. */
+#define THREAD_LOCAL          _Thread_local
+#elif defined(__GNUC__)
+#define THREAD_LOCAL          __thread
+#endif
+
+#ifndef SNPRINTF_PLACEHOLDER
+/** Output of conversion removed by SNPRINTF_NO_* feature switch. */
+#define SNPRINTF_PLACEHOLDER  "?"
+#endif
+
+/**
+ * Put a @p c character to @p out at @p count position if there is enough
+ * space and increase @p count.
+ */
+#define PUT_CHAR(c, out, count)                         \
+  if ((count) < (out).size) {                           \
+    if ((out).ps != NULL) {                             \
+      (out).ps[count] = (c);                            \
+    }                                                   \
+    (count)++;                                          \
   }
 
 /** Padding right optionally. */
-#define PAD_RIGHT(p)                                    \
-  if ((p)->width > 0 && (p)->align != ALIGN_LEFT) {     \
-    for (; (p)->width > 0; (p)->width--) {              \
-      PUT_CHAR((p)->pad, p);                            \
+#define PAD_RIGHT(s, out, count)                        \
+  if ((s)->width > 0 && !((s)->flags & FLAG_LEFT)) {    \
+    for (; (s)->width > 0; (s)->width--) {              \
+      PUT_CHAR((s)->pad, out, count);                   \
     }                                                   \
   }
 
 /** Padding left optionally. */
-#define PAD_LEFT(p)                                     \
-  if ((p)->width > 0 && (p)->align == ALIGN_LEFT) {     \
-    for (; (p)->width > 0; (p)->width--) {              \
-      PUT_CHAR((p)->pad, p);                            \
+#define PAD_LEFT(s, out, count)                         \
+  if ((s)->width > 0 && ((s)->flags & FLAG_LEFT)) {     \
+    for (; (s)->width > 0; (s)->width--) {              \
+      PUT_CHAR((s)->pad, out, count);                   \
     }                                                   \
   }
 
-/** Get width and precision arguments if available. */
-#define WIDTH_AND_PRECISION_ARGS(p)                     \
-  if ((p)->is_star_w) {                                 \
-    (p)->width = va_arg(args, int);                     \
+/**
+ * Get the next argument of @p type from variable arguments or, if is_vector
+ * is set, from array of tagged arguments (converted by arg_<kind>()
+ * function). is_vector is constant in each instance of conversion (@see
+ * CONVERSION), so there is no test for each argument.
+ */
+#define ARG(args, type, kind)                                           \
+  (is_vector ? (type)arg_##kind(args) : va_arg(*(args)->ap, type))
+
+/** Get string argument @p str and its @p len length (limited by precision). */
+#define STRING_ARG(s, str, len)                         \
+  if (is_vector) {                                      \
+    str = arg_string(args, (s)->precision, &len);       \
+  } else {                                              \
+    str = va_arg(*args->ap, const char *);              \
+    len = string_length(str, (s)->precision);           \
+  }
+
+/** Get pointer to @p data of @p type and its @p len length arguments. */
+#define SIZED_ARG(type, data, len)                      \
+  if (is_vector) {                                      \
+    data = (type)arg_sized(args, &len);                 \
+  } else {                                              \
+    data = va_arg(*args->ap, type);                     \
+    len = va_arg(*args->ap, size_t);                    \
+  }
+
+/**
+ * Get width and precision arguments if available. Negative width is
+ * taken as '-' flag followed by positive width, negative precision as
+ * if precision is not given.
+ */
+#define WIDTH_AND_PRECISION_ARGS(s)                     \
+  if ((s)->flags & FLAG_STAR_W) {                       \
+    (s)->width = ARG(args, int, integer);               \
+    if ((s)->width < 0) {                               \
+      (s)->flags |= FLAG_LEFT;                          \
+      (s)->pad = ' ';                                   \
+      (s)->width = (int)(0u - (unsigned int)(s)->width); \
+    }                                                   \
   }                                                     \
-  if ((p)->is_star_p) {                                 \
-    (p)->precision = va_arg(args, int);                 \
+  if ((s)->flags & FLAG_STAR_P) {                       \
+    (s)->precision = ARG(args, int, integer);           \
+    if ((s)->precision < 0) {                           \
+      (s)->precision = PRECISION_UNSET;                 \
+    }                                                   \
   }
 
-/** Get integer argument of given type and convert it to long long. */
-#define INTEGER_ARG(p, type, ll)                        \
-  WIDTH_AND_PRECISION_ARGS(p);                          \
-  if ((p)->a_long == INT_LEN_LONG_LONG) {               \
-    ll = (long long)va_arg(args, type long long);       \
-  } else if ((p)->a_long == INT_LEN_LONG) {             \
-    ll = (long long)va_arg(args, type long);            \
+/** Get integer argument of given type and convert it to LONGEST. */
+#define INTEGER_ARG(s, type, ll)                        \
+  WIDTH_AND_PRECISION_ARGS(s);                          \
+  INTEGER_VALUE_ARG(s, type, ll)
+
+/** Get only integer value argument (without width and precision). */
+#define INTEGER_VALUE_ARG(s, type, ll)                  \
+  if (LONG_LONG_ARG(s)) {                               \
+    ll = (LONGEST)ARG(args, type long long, integer);   \
+  } else if ((s)->length == INT_LEN_LONG) {             \
+    ll = (LONGEST)ARG(args, type long, integer);        \
   } else {                                              \
-    type int a = va_arg(args, type int);                \
-    if ((p)->a_long == INT_LEN_SHORT) {                 \
+    type int a = ARG(args, type int, integer);          \
+    if ((s)->length == INT_LEN_SHORT) {                 \
       ll = (type short)a;                               \
-    } else if ((p)->a_long == INT_LEN_CHAR) {           \
+    } else if ((s)->length == INT_LEN_CHAR) {           \
       ll = (type char)a;                                \
     } else {                                            \
       ll = a;                                           \
     }                                                   \
   }
 
-/** Get double argument. */
-#define DOUBLE_ARG(p, d)                                \
-  WIDTH_AND_PRECISION_ARGS(p);                          \
-  if ((p)->precision == PRECISION_UNSET) {              \
-    (p)->precision = 6;                                 \
-  }                                                     \
-  d = va_arg(args, double);
-
 /**
- * Convert maximum @p n characters of @p a string to integer.
- * 
- * Function stop conversion and return result in any of the following cases:
- *  - encounter end of string ('\0') character,
- *  - encounter non digit character,
- *  - reach @p n characters.
- * 
- * @return Integer (as type 'int') representation of @p a.
- *
-static int antoi(const char *a, size_t n) {
-  size_t i = 0;
-  int res = 0;
-
-  for (; a[i] != '\0' && i < n && isdigit(a[i]); i++) {
-    res = res * 10 + (a[i] - '0');
-  }
-
-  return res;
-}
+ * Get fixed point number arguments - @p scale and integer value @p ll.
+ * Precision of fixed point number is the same like for double argument.
  */
+#define FIXED_ARG(s, type, scale, ll)                   \
+  WIDTH_AND_PRECISION_ARGS(s);                          \
+  if ((s)->precision == PRECISION_UNSET) {              \
+    (s)->precision = 6;                                 \
+  }                                                     \
+  scale = ARG(args, int, integer);                      \
+  INTEGER_VALUE_ARG(s, type, ll)
 
-/**
- * Convert @p a string to @p res integer.
- * 
- * Function stop conversion and return result in any of the following cases:
- *  - encounter end of string ('\0') character,
- *  - encounter non digit character.
- * 
- * @param a Not NULL input string.
- * @param res Not NULL pointer to output integer.
- * 
- * @return Number of parsed character form @p a.
- */
-static int strtoi(const char *a, int *res) {
-  int i = 0;
+/** Get double argument. */
+#define DOUBLE_ARG(s, d)                                \
+  WIDTH_AND_PRECISION_ARGS(s);                          \
+  if ((s)->precision == PRECISION_UNSET) {              \
+    (s)->precision = 6;                                 \
+  }                                                     \
+  d = ARG(args, double, double);
 
-  *res = 0;
+/** Row of 10 pairs of decimal digits with @p h high digit. */
+#define DECIMAL_ROW(h)                                  \
+  h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7" h "8" h "9"
 
-  for (; a[i] != '\0' && isdigit(a[i]); i++) {
-    *res = *res * 10 + (a[i] - '0');
-  }
+/** Two decimal digits of numbers 0 ... 99. */
+static const char decimal_pairs[2 * 100 + 1] =
+  DECIMAL_ROW("0") DECIMAL_ROW("1") DECIMAL_ROW("2") DECIMAL_ROW("3")
+  DECIMAL_ROW("4") DECIMAL_ROW("5") DECIMAL_ROW("6") DECIMAL_ROW("7")
+  DECIMAL_ROW("8") DECIMAL_ROW("9");
 
-  return i;
-}
+/** Put two decimal digits of @p n (0 ... 99) number to @p p buffer. */
+#define PUT_PAIR(p, n)                                  \
+  memcpy((p), decimal_pairs + 2 * (n), 2)
 
 /**
  * Convert @p number to string representation of given @p base.
@@ -282,699 +417,4769 @@ static int strtoi(const char *a, int *res) {
  * @param is_signed Interpret @p number as 'unsigned' (0) / 'signed' (1).
  * @param precision Input @p number precision.
  * @param base Output base (8, 10, 16).
+ * @param separator Separator of groups of 3 digits ('\0' for none).
  * @param output Buffer for output string.
  * @param output_size Size of @p optput buffer (at least 3 characters).
  */
-static void inttoa(long long number, int is_signed, int precision, int base,
-    char *output, size_t output_size) {    
+static void inttoa(LONGEST number, int is_signed, int precision, int base,
+    char separator, char *output, size_t output_size) {
   size_t i = 0, j;
+  int digits = 0, is_negative = is_signed && number < 0;
+  unsigned LONGEST n;
 
   output_size--; /* for '\0' character */
 
-  if (number != 0) {
-    unsigned long long n;
+  if (is_negative) {
+    n = 0u - (unsigned LONGEST)number;
+    output_size--; /* for '-' character */
+  } else {
+    n = (unsigned LONGEST)number;
+  }
 
-    if (is_signed && number < 0) {
-      n = (unsigned long long)-number;
-      output_size--; /* for '-' character */
-    } else {
-      n = (unsigned long long)number;
-    }
+  if (number == 0 && precision < 0) { /* at least one digit of zero */
+    precision = 1;
+  }
 
-    while (n != 0 && i < output_size) {
-      int r = (int)(n % (unsigned long long)(base));
-      output[i++] = (char)r + (r < 10 ? '0' : 'a' - 10);
-      n /= (unsigned long long)(base);
+  if (base == 10 && separator == '\0') { /* two digits per division */
+    for (; n >= 100 && i + 1 < output_size; digits += 2) {
+      unsigned int r = (unsigned int)(n % 100);
+      output[i++] = decimal_pairs[2 * r + 1];
+      output[i++] = decimal_pairs[2 * r];
+      n /= 100;
     }
+  }
 
-    if (precision > 0) { /* precision defined ? */
-      for (; i < (size_t)precision && i < output_size; i++) {
-        output[i] = '0';
+  /* digits (and zeros of precision) from the least significant */
+  for (; (n != 0 || digits < precision) && i < output_size; digits++) {
+    int r = (int)(n % (unsigned LONGEST)(base));
+    if (separator != '\0' && digits > 0 && digits % 3 == 0) {
+      output[i++] = separator;
+      if (i == output_size) {
+        break;
       }
     }
+    output[i++] = (char)r + (r < 10 ? '0' : 'a' - 10);
+    n /= (unsigned LONGEST)(base);
+  }
 
-    /* put the sign ? */
-    if (is_signed && number < 0) {
-      output[i++] = '-';
-    }
+  /* put the sign ? */
+  if (is_negative) {
+    output[i++] = '-';
+  }
 
-    output[i] = '\0';
-    
-    /* reverse every thing */
-    for (i--, j = 0; j < i; j++, i--) {
-      char tmp = output[i];
-      output[i] = output[j];
-      output[j] = tmp;
-    }
-  } else {
-    precision = precision < 0 ? 1 : precision;
-    for (i = 0; i < (size_t)precision && i < output_size; i++) {
-      output[i] = '0';
-    }
-    output[i] = '\0';
+  output[i] = '\0';
+
+  /* reverse every thing */
+  for (j = 0; i > 0 && j < --i; j++) {
+    char tmp = output[i];
+    output[i] = output[j];
+    output[j] = tmp;
+  }
+}
+
+#if !defined(SNPRINTF_NO_FLOAT) || defined(SNPRINTF_SCAN)
+/** Amount of leading zero bits of not 0 @p w. */
+static int leading_zeros(unsigned long long w) {
+#ifdef __GNUC__
+  return __builtin_clzll(w);
+#else
+  int n = 0;
+
+  for (; (w >> 63) == 0; w <<= 1) {
+    n++;
   }
+
+  return n;
+#endif
 }
+#endif
+
+#if !defined(SNPRINTF_NO_FLOAT) && defined(SNPRINTF_SCAN)
+/** Powers of 10 for exponents 2^0, 2^1 ... 2^8. */
+static const double pow_10_table[] = {
+  1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256
+};
 
-/** Find the nth power of 10. */
+/** Find the nth power of 10 (exact for |n| <= 22). */
 static double pow_10(int n) {
-  int i = 1;
-  double p = 1., m;
+  int i = 0, is_negative = n < 0;
+  double p = 1.;
 
-  if (n < 0) {
+  if (is_negative) {
     n = -n;
-    m = .1;
-  } else {
-    m = 10.;
   }
 
-  for (; i <= n; i++) {
-    p *= m;
+  for (; n != 0 && i < (int)(sizeof(pow_10_table) / sizeof(*pow_10_table));
+      n >>= 1, i++) {
+    if (n & 1) {
+      p *= pow_10_table[i];
+    }
   }
 
-  return p;
+  return is_negative ? 1. / p : p;
 }
+#endif
 
-/**
- * Function find the integral part of the log in base 10.
- * 
- * @note This not a real log10().
- *    I just need and approximation (integerpart) of x in:
- *      10^x ~= r
- *   
- *    log_10(200) = 2;
- *    log_10(250) = 2;
- */
-static int log_10(double r) {
-  int i = 0;
-  double result = 1.;
+#ifndef SNPRINTF_NO_FLOAT
+/** The lowest power of pow_5_128 table. */
+#define POW_5_MIN             (-342)
+/** The highest power of pow_5_128 table. */
+#define POW_5_MAX             340
 
-  if (r == 0.) {
-    return 0;
-  }
-  
-  if (r < 0.) {
-    r = -r;
-  }
+/** floor(log2(10^q)) for |q| <= 400 (without floating point arithmetic). */
+#define FLOOR_LOG2_10(q)      (((q) * 217706 - ((q) < 0 ? 65535 : 0)) / 65536)
+/** floor(log10(2^e)) for |e| <= 1200 (without floating point arithmetic). */
+#define FLOOR_LOG10_2(e)      (((e) * 78913 - ((e) < 0 ? 262143 : 0)) / 262144)
 
-  if (r < 1.) {
-    for (; result >= r; i++) {
-      result *= .1;
-    }
+/**
+ * Powers of 5 (5^-342 ... 5^340) as the highest 128 bits with the highest
+ * bit set (negative powers rounded up) - high and low 64-bit words. They
+ * scale numbers by powers of 10 in both directions - decimal digits of
+ * double (scale()) and double of decimal digits (eisel_lemire()).
+ */
+static const unsigned long long pow_5_128[2 * (POW_5_MAX - POW_5_MIN + 1)] = {
+  0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+  0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+  0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+  0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+  0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+  0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+  0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+  0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+  0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+  0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+  0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+  0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+  0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+  0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+  0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+  0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+  0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+  0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+  0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+  0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+  0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+  0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+  0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+  0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+  0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+  0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+  0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+  0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+  0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+  0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+  0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+  0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+  0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+  0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+  0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+  0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+  0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+  0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+  0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+  0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+  0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+  0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+  0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+  0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+  0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+  0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+  0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+  0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+  0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+  0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+  0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+  0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+  0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+  0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+  0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+  0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+  0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+  0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+  0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+  0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+  0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+  0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+  0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+  0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+  0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+  0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+  0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+  0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+  0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+  0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+  0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+  0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+  0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+  0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+  0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+  0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+  0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+  0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+  0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+  0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+  0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+  0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+  0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+  0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+  0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+  0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+  0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+  0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+  0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+  0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+  0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+  0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+  0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+  0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+  0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+  0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+  0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+  0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+  0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+  0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+  0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+  0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+  0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+  0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+  0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+  0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+  0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+  0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+  0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+  0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+  0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+  0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+  0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+  0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+  0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+  0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+  0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+  0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+  0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+  0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+  0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+  0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+  0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+  0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+  0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+  0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+  0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+  0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+  0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+  0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+  0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+  0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+  0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+  0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+  0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+  0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+  0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+  0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+  0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+  0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+  0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+  0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+  0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+  0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+  0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+  0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+  0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+  0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+  0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+  0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+  0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+  0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+  0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+  0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+  0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+  0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+  0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+  0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+  0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+  0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+  0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+  0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+  0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+  0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+  0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+  0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+  0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+  0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+  0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+  0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+  0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+  0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+  0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+  0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+  0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+  0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+  0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+  0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+  0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+  0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+  0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+  0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+  0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+  0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+  0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+  0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+  0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+  0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+  0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+  0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+  0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+  0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+  0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+  0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+  0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+  0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+  0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+  0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+  0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+  0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+  0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+  0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+  0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+  0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+  0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+  0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+  0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+  0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+  0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+  0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+  0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+  0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+  0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+  0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+  0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+  0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+  0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+  0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+  0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+  0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+  0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+  0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+  0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+  0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+  0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+  0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+  0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+  0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+  0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+  0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+  0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+  0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+  0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+  0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+  0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+  0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+  0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+  0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+  0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+  0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+  0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+  0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+  0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+  0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+  0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+  0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+  0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+  0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+  0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+  0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+  0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+  0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+  0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+  0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+  0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+  0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+  0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+  0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+  0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+  0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+  0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+  0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+  0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+  0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+  0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+  0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+  0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+  0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+  0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+  0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+  0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+  0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+  0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+  0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+  0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+  0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+  0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+  0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+  0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+  0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+  0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+  0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+  0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+  0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+  0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+  0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+  0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+  0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+  0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+  0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+  0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+  0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+  0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+  0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+  0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+  0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+  0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+  0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+  0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+  0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+  0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+  0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+  0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+  0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+  0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+  0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+  0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+  0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+  0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+  0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+  0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+  0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+  0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+  0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+  0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+  0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+  0xc612062576589ddaULL, 0x95364afe032a819eULL,
+  0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+  0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+  0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+  0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+  0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+  0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+  0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+  0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+  0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+  0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+  0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+  0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+  0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+  0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+  0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+  0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+  0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+  0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+  0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+  0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+  0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+  0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+  0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+  0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+  0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+  0x8000000000000000ULL, 0x0000000000000000ULL,
+  0xa000000000000000ULL, 0x0000000000000000ULL,
+  0xc800000000000000ULL, 0x0000000000000000ULL,
+  0xfa00000000000000ULL, 0x0000000000000000ULL,
+  0x9c40000000000000ULL, 0x0000000000000000ULL,
+  0xc350000000000000ULL, 0x0000000000000000ULL,
+  0xf424000000000000ULL, 0x0000000000000000ULL,
+  0x9896800000000000ULL, 0x0000000000000000ULL,
+  0xbebc200000000000ULL, 0x0000000000000000ULL,
+  0xee6b280000000000ULL, 0x0000000000000000ULL,
+  0x9502f90000000000ULL, 0x0000000000000000ULL,
+  0xba43b74000000000ULL, 0x0000000000000000ULL,
+  0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+  0x9184e72a00000000ULL, 0x0000000000000000ULL,
+  0xb5e620f480000000ULL, 0x0000000000000000ULL,
+  0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+  0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+  0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+  0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+  0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+  0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+  0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+  0x878678326eac9000ULL, 0x0000000000000000ULL,
+  0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+  0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+  0x84595161401484a0ULL, 0x0000000000000000ULL,
+  0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+  0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+  0x813f3978f8940984ULL, 0x4000000000000000ULL,
+  0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+  0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+  0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+  0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+  0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+  0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+  0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+  0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+  0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+  0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+  0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+  0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+  0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+  0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+  0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+  0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+  0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+  0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+  0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+  0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+  0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+  0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+  0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+  0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+  0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+  0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+  0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+  0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+  0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+  0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+  0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+  0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+  0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+  0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+  0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+  0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+  0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+  0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+  0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+  0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+  0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+  0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+  0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+  0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+  0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+  0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+  0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+  0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+  0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+  0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+  0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+  0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+  0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+  0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+  0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+  0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+  0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+  0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+  0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+  0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+  0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+  0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+  0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+  0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+  0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+  0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+  0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+  0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+  0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+  0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+  0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+  0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+  0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+  0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+  0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+  0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+  0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+  0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+  0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+  0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+  0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+  0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+  0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+  0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+  0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+  0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+  0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+  0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+  0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+  0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+  0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+  0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+  0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+  0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+  0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+  0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+  0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+  0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+  0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+  0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+  0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+  0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+  0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+  0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+  0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+  0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+  0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+  0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+  0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+  0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+  0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+  0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+  0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+  0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+  0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+  0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+  0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+  0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+  0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+  0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+  0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+  0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+  0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+  0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+  0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+  0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+  0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+  0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+  0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+  0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+  0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+  0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+  0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+  0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+  0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+  0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+  0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+  0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+  0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+  0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+  0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+  0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+  0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+  0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+  0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+  0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+  0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+  0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+  0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+  0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+  0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+  0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+  0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+  0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+  0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+  0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+  0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+  0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+  0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+  0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+  0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+  0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+  0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+  0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+  0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+  0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+  0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+  0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+  0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+  0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+  0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+  0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+  0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+  0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+  0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+  0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+  0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+  0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+  0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+  0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+  0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+  0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+  0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+  0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+  0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+  0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+  0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+  0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+  0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+  0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+  0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+  0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+  0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+  0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+  0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+  0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+  0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+  0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+  0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+  0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+  0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+  0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+  0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+  0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+  0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+  0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+  0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+  0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+  0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+  0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+  0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+  0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+  0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+  0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+  0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+  0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+  0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+  0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+  0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+  0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+  0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+  0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+  0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+  0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+  0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+  0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+  0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+  0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+  0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+  0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+  0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+  0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+  0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+  0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+  0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+  0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+  0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+  0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+  0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+  0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+  0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+  0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+  0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+  0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+  0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+  0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+  0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+  0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+  0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+  0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+  0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+  0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+  0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+  0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+  0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+  0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+  0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+  0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+  0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+  0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+  0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+  0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+  0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+  0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+  0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+  0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+  0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+  0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+  0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+  0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+  0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+  0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+  0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+  0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+  0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+  0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+  0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+  0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+  0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+  0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL,
+  0xb201833b35d63f73ULL, 0x2cd2cc6551e513daULL,
+  0xde81e40a034bcf4fULL, 0xf8077f7ea65e58d1ULL,
+  0x8b112e86420f6191ULL, 0xfb04afaf27faf782ULL,
+  0xadd57a27d29339f6ULL, 0x79c5db9af1f9b563ULL,
+  0xd94ad8b1c7380874ULL, 0x18375281ae7822bcULL,
+  0x87cec76f1c830548ULL, 0x8f2293910d0b15b5ULL,
+  0xa9c2794ae3a3c69aULL, 0xb2eb3875504ddb22ULL,
+  0xd433179d9c8cb841ULL, 0x5fa60692a46151ebULL,
+  0x849feec281d7f328ULL, 0xdbc7c41ba6bcd333ULL,
+  0xa5c7ea73224deff3ULL, 0x12b9b522906c0800ULL,
+  0xcf39e50feae16befULL, 0xd768226b34870a00ULL,
+  0x81842f29f2cce375ULL, 0xe6a1158300d46640ULL,
+  0xa1e53af46f801c53ULL, 0x60495ae3c1097fd0ULL,
+  0xca5e89b18b602368ULL, 0x385bb19cb14bdfc4ULL,
+  0xfcf62c1dee382c42ULL, 0x46729e03dd9ed7b5ULL,
+  0x9e19db92b4e31ba9ULL, 0x6c07a2c26a8346d1ULL,
+  0xc5a05277621be293ULL, 0xc7098b7305241885ULL,
+  0xf70867153aa2db38ULL, 0xb8cbee4fc66d1ea7ULL,
+  0x9a65406d44a5c903ULL, 0x737f74f1dc043328ULL,
+  0xc0fe908895cf3b44ULL, 0x505f522e53053ff2ULL,
+  0xf13e34aabb430a15ULL, 0x647726b9e7c68fefULL,
+  0x96c6e0eab509e64dULL, 0x5eca783430dc19f5ULL,
+  0xbc789925624c5fe0ULL, 0xb67d16413d132072ULL,
+  0xeb96bf6ebadf77d8ULL, 0xe41c5bd18c57e88fULL,
+  0x933e37a534cbaae7ULL, 0x8e91b962f7b6f159ULL,
+  0xb80dc58e81fe95a1ULL, 0x723627bbb5a4adb0ULL,
+  0xe61136f2227e3b09ULL, 0xcec3b1aaa30dd91cULL,
+  0x8fcac257558ee4e6ULL, 0x213a4f0aa5e8a7b1ULL,
+  0xb3bd72ed2af29e1fULL, 0xa988e2cd4f62d19dULL,
+  0xe0accfa875af45a7ULL, 0x93eb1b80a33b8605ULL,
+  0x8c6c01c9498d8b88ULL, 0xbc72f130660533c3ULL,
+  0xaf87023b9bf0ee6aULL, 0xeb8fad7c7f8680b4ULL
+};
 
-    i = -i;
-  } else {
-    for (; result <= r; i++) {
-      result *= 10.;
-    }
+/** Full 128-bit product of @p a and @p b - returns low word, @p high word. */
+static unsigned long long multiply_64(unsigned long long a,
+    unsigned long long b, unsigned long long *high) {
+#ifdef SNPRINTF_INT128
+  UINT128 r = (UINT128)a * b;
+
+  *high = (unsigned long long)(r >> 64);
+  return (unsigned long long)r;
+#else
+  unsigned long long al = a & 0xffffffff, ah = a >> 32;
+  unsigned long long bl = b & 0xffffffff, bh = b >> 32;
+  unsigned long long ll = al * bl, lh = al * bh, hl = ah * bl;
+  unsigned long long mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+
+  *high = ah * bh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  return (mid << 32) | (ll & 0xffffffff);
+#endif
+}
+#endif
 
-    --i;
+/** Maximum size of the buffer for the integral part. */
+#define MAX_INTEGRAL_SIZE (99 + 1)
+
+/**
+ * Return sign character of number according to @p s flags: '-' for negative
+ * number, '+' or ' ' for not negative number if requested or '\0' if none.
+ */
+static char sign_char(const struct SPEC *s, int is_negative) {
+  if (is_negative) {
+    return '-';
+  } else if (s->flags & FLAG_PLUS) {
+    return '+';
   }
 
-  return i;
+  return (s->flags & FLAG_SPACE) ? ' ' : '\0';
 }
 
 /**
- * Function return the fraction part of a @p real and set in @p ip the integral
- * part. In many ways it resemble the modf() found on most Un*x.
+ * Put @p number digits after @p prefix (sign, '0' or "0x") in field of
+ * @p s width. Zeros of '0' flag go between prefix and digits, the flag is
+ * ignored when precision is given.
+ *
+ * @return Amount of characters put to @p out (with @p count).
  */
-static double integral(double real, double *ip) {
-  int log;
-  double real_integral = 0.;
-
-  /* equal to zero ? */
-  if (real == 0.) {
-    *ip = 0.;
-    return 0.;
+static size_t integer_field(struct OUT out, size_t count, struct SPEC *s,
+    const char *prefix, const char *number) {
+  s->width -= (int)(strlen(prefix) + strlen(number));
+  if (s->precision != PRECISION_UNSET) {
+    s->pad = ' ';
   }
 
-  /* negative number ? */
-  if (real < 0.) {
-    real = -real;
+  if (s->pad != '0') {
+    PAD_RIGHT(s, out, count);
   }
-
-  /* a fraction ? */
-  if (real < 1.) {
-    *ip = 0.;
-    return real;
+  for (; *prefix != '\0'; prefix++) {
+    PUT_CHAR(*prefix, out, count);
   }
+  PAD_RIGHT(s, out, count);
 
-  /* the real work :-) */
-  for (log = log_10(real); log >= 0; log--) {
-    double i = 0., p = pow_10(log);
-    double s = (real - real_integral) / p;
-    for (; i + 1. <= s; i++) {}
-    real_integral += i * p;
+  for (; *number != '\0'; number++) {
+    PUT_CHAR((s->conv == 'X' ? (char)toupper(*number) : *number), out, count);
   }
 
-  *ip = real_integral;
-  return (real - real_integral);
+  PAD_LEFT(s, out, count);
+  return count;
 }
 
-/** Maximum size of the buffer for the integral part. */
-#define MAX_INTEGRAL_SIZE (99 + 1)
-/** Maximum size of the buffer for the fraction part. */
-#define MAX_FRACTION_SIZE (29 + 1)
-/** Precision. */
-#define PRECISION (1.e-6)
-
 /**
- * Return an ASCII representation of the integral and fraction
- * part of the @p number.
+ * Format @p ll number as ASCII decimal string according to @p s flags.
+ *
+ * @param out Output of formatting.
+ * @param count Amount of characters already put to @p out.
+ * @param s Specification of field.
+ * @param ll Number to format.
+ *
+ * @return Amount of characters put to @p out (with @p count).
  */
-static void floattoa(double number, int precision,
-    char *output_integral, size_t output_integral_size,
-    char *output_fraction, size_t output_fraction_size) {
+static size_t decimal(struct OUT out, size_t count, struct SPEC *s,
+    LONGEST ll) {
+  char number[MAX_INTEGRAL_SIZE], prefix[2] = { '\0', '\0' };
+  int is_signed = s->conv == 'i' || s->conv == 'd';
+  inttoa(ll, is_signed, s->precision, 10,
+    (s->flags & FLAG_QUOTE) ? ',' : '\0', number, sizeof(number));
+
+  if (is_signed) { /* '+' and ' ' flags only for signed conversion */
+    prefix[0] = sign_char(s, *number == '-');
+  }
 
-  size_t i, j;
-  int is_negative = 0;
-  double ip, fp; /* integer and fraction part */
-  double fraction;
+  return integer_field(out, count, s, prefix, number + (*number == '-'));
+}
 
-  /* taking care of the obvious case: 0.0 */
-  if (number == 0.) {
-    output_integral[0] = output_fraction[0] = '0';
-    output_integral[1] = output_fraction[1] = '\0';
+#ifndef SNPRINTF_NO_OCTAL
+/** Format @p ll number as ASCII octal string according to @p s flags. */
+static size_t octal(struct OUT out, size_t count, struct SPEC *s,
+    LONGEST ll) {
+  char number[MAX_INTEGRAL_SIZE];
+  inttoa(ll, 0, s->precision, 8, '\0', number, sizeof(number));
 
-    return;
-  }
+  /* '#' flag makes the first digit zero */
+  return integer_field(out, count, s,
+    (s->flags & FLAG_SQUARE) && *number != '0' ? "0" : "", number);
+}
+#endif
 
-  /* for negative numbers */
-  if (number < 0.) {
-    number = -number;
-    is_negative = 1;
-    output_integral_size--; /* sign consume one digit */
-  }
+/** Format @p ll number as ASCII hexadecimal string according to @p s flags. */
+static size_t hex(struct OUT out, size_t count, struct SPEC *s,
+    LONGEST ll) {
+  char number[MAX_INTEGRAL_SIZE], prefix[3] = { '0', 'x', '\0' };
+  inttoa(ll, 0, s->precision, 16, '\0', number, sizeof(number));
 
-  fraction = integral(number, &ip);
-  number = ip;
-  /* do the integral part */
-  if (ip == 0.) {
-    output_integral[0] = '0';
-    i = 1;
+  /* '#' flag puts "0x" before not zero number only */
+  if ((s->flags & FLAG_SQUARE) && ll != 0) {
+    prefix[1] = s->conv == 'X' ? 'X' : 'x';
   } else {
-    for (i = 0; i < output_integral_size - 1 && number != 0.; ++i) {
-      number /= 10;
-      /* force to round */
-      output_integral[i] = (char)((integral(number, &ip) + PRECISION) * 10) + '0';
-      if (!isdigit(output_integral[i])) { /* bail out overflow !! */
-        break;
-      }
-      number = ip;
-    }
+    prefix[0] = '\0';
   }
 
-  /* Oh No !! out of bound, ho well fill it up ! */
-  if (number != 0.) {
-    for (i = 0; i < output_integral_size - 1; ++i) {
-      output_integral[i] = '9';
-    }
-  }
+  return integer_field(out, count, s, prefix, number);
+}
 
-  /* put the sign ? */
+#ifdef SNPRINTF_INT128
+/**
+ * Convert @p n 128-bit number to string representation of given @p base
+ * like inttoa(). Decimal number is divided into chunks of 19 digits (one
+ * 128-by-64 division per chunk), octal and hexadecimal into chunks of 63
+ * and 60 bits, so digits of chunks are got by 64-bit arithmetic.
+ *
+ * @param n Absolute value of input number.
+ * @param is_negative Put '-' before digits.
+ * @param precision Input @p number precision.
+ * @param base Output base (8, 10, 16).
+ * @param separator Separator of groups of 3 digits ('\0' for none).
+ * @param output Buffer for output string.
+ * @param output_size Size of @p optput buffer (at least 3 characters).
+ */
+static void int128toa(UINT128 n, int is_negative, int precision, int base,
+    char separator, char *output, size_t output_size) {
+  const int chunk_bits = base == 16 ? 60 : 63;
+  const int chunk_digits = base == 10 ? 19 : (base == 16 ? 15 : 21);
+  unsigned long long chunk;
+  size_t i = 0, j;
+  int digits = 0, k;
+
+  output_size--; /* for '\0' character */
   if (is_negative) {
-    output_integral[i++] = '-';
+    output_size--; /* for '-' character */
   }
 
-  output_integral[i] = '\0';
-
-  /* reverse every thing */
-  for (i--, j = 0; j < i; j++, i--) {
-    char tmp = output_integral[i];
-    output_integral[i] = output_integral[j];
-    output_integral[j] = tmp;
+  if (n == 0 && precision < 0) { /* at least one digit of zero */
+    precision = 1;
   }
 
-  /* the fractional part */
-  for (i = 0, fp = fraction; precision > 0 && i < output_fraction_size - 1; i++, precision--) {
-    output_fraction[i] = (char)(int)((fp + PRECISION) * 10. + '0');
-    if (!isdigit(output_fraction[i])) { /* underflow ? */
-      break;
+  while ((n != 0 || digits < precision) && i < output_size) {
+    if ((n >> 64) == 0) { /* the last chunk */
+      chunk = (unsigned long long)n;
+      n = 0;
+      k = 0;
+    } else if (base == 10) {
+      UINT128 q = n / 10000000000000000000ULL;
+      chunk = (unsigned long long)(n - q * 10000000000000000000ULL);
+      n = q;
+      k = chunk_digits;
+    } else {
+      chunk = (unsigned long long)n & ((1ULL << chunk_bits) - 1);
+      n >>= chunk_bits;
+      k = chunk_digits;
     }
 
-    fp = (fp * 10.0) - (double)(long)((fp + PRECISION) * 10.);
+    /* all digits of chunk inside of number, zeros of precision after it */
+    for (; (chunk != 0 || k > 0 || (n == 0 && digits < precision)) &&
+        i < output_size; digits++, k--) {
+      int r = (int)(chunk % (unsigned int)base);
+      if (separator != '\0' && digits > 0 && digits % 3 == 0) {
+        output[i++] = separator;
+        if (i == output_size) {
+          break;
+        }
+      }
+      output[i++] = (char)r + (r < 10 ? '0' : 'a' - 10);
+      chunk /= (unsigned int)base;
+    }
   }
-  output_fraction[i] = '\0';
-}
-
-/** Format @p ll number as ASCII decimal string according to @p p flags. */
-static void decimal(struct DATA *p, long long ll) {
-  char number[MAX_INTEGRAL_SIZE], *pnumber = number;
-  inttoa(ll, *p->pf == 'i' || *p->pf == 'd', p->precision, 10,
-    number, sizeof(number));
 
-  p->width -= strlen(number);
-  PAD_RIGHT(p);
+  if (is_negative) {
+    output[i++] = '-';
+  }
 
-  PUT_PLUS(ll, p);
-  PUT_SPACE(ll, p);
+  output[i] = '\0';
 
-  for (; *pnumber != '\0'; pnumber++) {
-    PUT_CHAR(*pnumber, p);
+  /* reverse every thing */
+  for (j = 0; i > 0 && j < --i; j++) {
+    char tmp = output[i];
+    output[i] = output[j];
+    output[j] = tmp;
   }
-
-  PAD_LEFT(p);
 }
 
-/** Format @p ll number as ASCII octal string according to @p p flags. */
-static void octal(struct DATA *p, long long ll) {
-  char number[MAX_INTEGRAL_SIZE], *pnumber = number;
-  inttoa(ll, 0, p->precision, 8, number, sizeof(number));
+/**
+ * Format @p n 128-bit number in @p base (8, 10, 16) according to @p s flags
+ * like decimal(), octal() or hex().
+ */
+static size_t integer128(struct OUT out, size_t count, struct SPEC *s,
+    int base, UINT128 n, int is_negative) {
+  char number[MAX_INTEGRAL_SIZE], prefix[3] = { '\0', '\0', '\0' };
+  int128toa(n, 0, s->precision, base,
+    base == 10 && (s->flags & FLAG_QUOTE) ? ',' : '\0', number,
+    sizeof(number));
+
+  if (base == 10 && (s->conv == 'd' || s->conv == 'i')) {
+    prefix[0] = sign_char(s, is_negative);
+  } else if ((s->flags & FLAG_SQUARE) && base == 8 && *number != '0') {
+    prefix[0] = '0';
+  } else if ((s->flags & FLAG_SQUARE) && base == 16 && n != 0) {
+    prefix[0] = '0';
+    prefix[1] = s->conv == 'X' ? 'X' : 'x';
+  }
 
-  p->width -= strlen(number);
-  PAD_RIGHT(p);
+  return integer_field(out, count, s, prefix, number);
+}
+#endif
 
-  if (p->is_square && *number != '\0') { /* prefix '0' for octal */
-    PUT_CHAR('0', p);
+/**
+ * Put @p len characters of @p str to @p out at @p count position (as many
+ * as there is space for) and return increased @p count.
+ */
+static size_t put_chars(struct OUT out, size_t count, const char *str,
+    size_t len) {
+  if (len > out.size - count) {
+    len = out.size - count;
+  }
+  if (out.ps != NULL) {
+    memcpy(out.ps + count, str, len);
   }
+  return count + len;
+}
+
+/**
+ * Get length of @p str string, but not more than @p precision (if defined).
+ * Only first @p precision characters are read, so @p str does not need to
+ * be terminated by '\0' if it is not shorter.
+ */
+static size_t string_length(const char *str, int precision) {
+  const char *end;
 
-  for (; *pnumber != '\0'; pnumber++) {
-    PUT_CHAR(*pnumber, p);
+  if (precision == PRECISION_UNSET) {
+    return strlen(str);
   }
 
-  PAD_LEFT(p);
+  end = (const char *)memchr(str, '\0', (size_t)precision);
+  return end != NULL ? (size_t)(end - str) : (size_t)precision;
 }
 
-/** Format @p ll number as ASCII hexadecimal string according to @p p flags. */
-static void hex(struct DATA *p, long long ll) {
-  char number[MAX_INTEGRAL_SIZE], *pnumber = number;
-  inttoa(ll, 0, p->precision, 16, number, sizeof(number));
+/** Format @p len characters of @p str according to @p s flags. */
+static size_t slice(struct OUT out, size_t count, struct SPEC *s,
+    const char *str, size_t len) {
+  if (s->precision != PRECISION_UNSET && len > (size_t)s->precision) { /* the smallest number */
+    len = (size_t)s->precision;
+  }
 
-  p->width -= strlen(number);
-  PAD_RIGHT(p);
+  s->width = s->width > 0 && (size_t)s->width > len ? s->width - (int)len : 0;
 
-  if (p->is_square && *number != '\0') { /* prefix '0x' for hex */
-    PUT_CHAR('0', p);
-    PUT_CHAR(*p->pf == 'p' ? 'x' : *p->pf, p);
-  }
+  PAD_RIGHT(s, out, count);
 
-  for (; *pnumber != '\0'; pnumber++) {
-    PUT_CHAR((*p->pf == 'X' ? (char)toupper(*pnumber) : *pnumber), p);
-  }
+  count = put_chars(out, count, str, len);
 
-  PAD_LEFT(p);
+  PAD_LEFT(s, out, count);
+  return count;
 }
 
-/** Format @p str string according to @p p flags. */
-static void strings(struct DATA *p, char *s) {
-  int len = (int)strlen(s);
-  if (p->precision != PRECISION_UNSET && len > p->precision) { /* the smallest number */
-    len = p->precision;
-  }
+/** Format @p str string according to @p s flags. */
+static size_t strings(struct OUT out, size_t count, struct SPEC *s,
+    const char *str) {
+  return slice(out, count, s, str, string_length(str, s->precision));
+}
 
-  p->width -= len;
+/**
+ * Put 8 binary digits of @p byte to @p p buffer (the most significant the
+ * first). Every bit is moved to its own byte by multiplication, so there is
+ * no loop over bits.
+ */
+static void byte_to_bits(char *p, unsigned int byte) {
+  unsigned long long x = (byte * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+  int i;
 
-  PAD_RIGHT(p);
+  /* every byte is 0 or a power of 2 -> 0 or 1 -> '0' or '1' */
+  x = ((x + 0x7f7f7f7f7f7f7f7fULL) >> 7) & 0x0101010101010101ULL;
+  x += 0x3030303030303030ULL;
 
-  for (; len-- > 0; s++) {
-    PUT_CHAR(*s, p);
+  for (i = 0; i < 8; i++) {
+    p[i] = (char)(x >> (8 * i));
   }
-
-  PAD_LEFT(p);
 }
 
-/** 
- * Format @p d floating point number as ASCII decimal floating point 
- * according to @p p flags.
+/**
+ * Format @p ll number as ASCII binary string according to @p s flags:
+ * prefix "0b" ("0B") with '#' and groups of 4 digits separated by '_' with
+ * '\''.
  */
-static void floating(struct DATA *p, double d) {
-  char integral[MAX_INTEGRAL_SIZE], *pintegral = integral;
-  char fraction[MAX_FRACTION_SIZE], *pfraction = fraction;
+static size_t binary(struct OUT out, size_t count, struct SPEC *s,
+    LONGEST ll) {
+  unsigned LONGEST n = (unsigned LONGEST)ll;
+  char bits[LONGEST_BITS];
+  const char *one;
+  int digits, total, i, is_grouped = (s->flags & FLAG_QUOTE) != 0;
+  int is_prefixed = (s->flags & FLAG_SQUARE) && n != 0;
+
+  for (i = 0; i < LONGEST_BITS / 8; i++) {
+    byte_to_bits(bits + LONGEST_BITS - 8 * (i + 1),
+      (unsigned int)(n >> (8 * i)) & 0xff);
+  }
+  one = (const char *)memchr(bits, '1', sizeof(bits));
+  digits = one != NULL ? (int)(bits + LONGEST_BITS - one) : 0;
+
+  total = s->precision == PRECISION_UNSET ? 1 : s->precision;
+  total = digits > total ? digits : total;
 
-  d = ROUND_TO_PRECISION(d, p);
-  floattoa(d, p->precision,
-    integral, sizeof(integral), fraction, sizeof(fraction));
-    
-  /* calculate the padding. 1 for the dot */
-  if (d > 0. && p->align == ALIGN_RIGHT) {
-    p->width -= 1;  
+  s->width -= total + (is_grouped && total > 0 ? (total - 1) / 4 : 0) +
+    (is_prefixed ? 2 : 0);
+
+  if (s->pad != '0') {
+    PAD_RIGHT(s, out, count);
   }
-  p->width -= p->is_space + (int)strlen(integral) + p->precision + 1;
-  if (p->precision == 0) {
-    p->width += 1;
+  if (is_prefixed) {
+    PUT_CHAR('0', out, count);
+    PUT_CHAR(s->conv, out, count);
   }
-  
-  PAD_RIGHT(p);
-  PUT_PLUS(d, p);
-  PUT_SPACE(d, p);
-
-  for (; *pintegral != '\0'; pintegral++) {
-    PUT_CHAR(*pintegral, p);
+  if (s->pad == '0') {
+    PAD_RIGHT(s, out, count);
   }
 
-  if (p->precision != 0 || p->is_square) { /* put the '.' */
-    PUT_CHAR('.', p);
+  if (!is_grouped && total <= LONGEST_BITS) {
+    count = put_chars(out, count, bits + LONGEST_BITS - total, (size_t)total);
+  } else {
+    for (i = total - 1; i >= 0; i--) {
+      if (is_grouped && i % 4 == 3 && i != total - 1) {
+        PUT_CHAR('_', out, count);
+      }
+      PUT_CHAR(i < LONGEST_BITS ? bits[LONGEST_BITS - 1 - i] : '0', out, count);
+    }
   }
 
-  if (*p->pf == 'g' || *p->pf == 'G') { /* smash the trailing zeros */
-    size_t i;
-    for (i = strlen(fraction); i > 0 && fraction[i - 1] == '0'; i--) {
-      fraction[i - 1] = '\0';
+  PAD_LEFT(s, out, count);
+  return count;
+}
+
+/** Does @p c character need escape in JSON string? */
+#define JSON_ESCAPED(c)                                 \
+  ((unsigned char)(c) < 0x20 || (c) == '"' || (c) == '\\')
+
+/**
+ * Escapes of control characters in JSON string ('u' means "\u00XX", the
+ * rest of them are put after '\').
+ */
+static const char json_controls[0x20] = "uuuuuuuubtnufruuuuuuuuuuuuuuuuuu";
+
+/** Get length of prefix of @p str of @p len characters without escapes. */
+static size_t json_clean(const char *str, size_t len) {
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control = _mm_set1_epi8(0x1f);
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(str + i));
+    __m128i m = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+      _mm_cmpeq_epi8(_mm_min_epu8(v, control), v)); /* v <= 0x1f */
+    int mask = _mm_movemask_epi8(m);
+    if (mask != 0) {
+      return i + (size_t)__builtin_ctz((unsigned int)mask);
     }
   }
+#endif
 
-  for (; *pfraction != '\0'; pfraction++) {
-    PUT_CHAR(*pfraction, p);
+  for (; i < len && !JSON_ESCAPED(str[i]); i++) {
   }
 
-  PAD_LEFT(p);
+  return i;
 }
 
-/** 
- * Format @p d floating point number as ASCII scientific (exponential)
- * floating point according to @p p flags.
- */
-static void exponent(struct DATA *p, double d) {
-  char integral[MAX_INTEGRAL_SIZE], *pintegral = integral;
-  char fraction[MAX_FRACTION_SIZE], *pfraction = fraction;
-  int log = log_10(d);
-  d /= pow_10(log); /* get the Mantissa */
-  d = ROUND_TO_PRECISION(d, p);
+/** Get length of @p str of @p len characters escaped for JSON string. */
+static size_t json_length(const char *str, size_t len) {
+  size_t n = 0, clean;
+  unsigned char c;
 
-  floattoa(d, p->precision,
-    integral, sizeof(integral), fraction, sizeof(fraction));
-  /* 1 for unit, 1 for the '.', 1 for 'e|E',
-   * 1 for '+|-', 2 for 'exp' */
-  /* calculate how much padding need */
-  if (d > 0. && p->align == ALIGN_RIGHT) {
-    p->width -= 1;  
+  for (;;) {
+    clean = json_clean(str, len);
+    n += clean;
+    if (clean == len) {
+      return n;
+    }
+    c = (unsigned char)str[clean];
+    n += (c < 0x20 && json_controls[c] == 'u') ? 6 : 2;
+    str += clean + 1;
+    len -= clean + 1;
   }
-  p->width -= p->is_space + p->precision + 7;
-  
-  PAD_RIGHT(p);
-  PUT_PLUS(d, p);
-  PUT_SPACE(d, p);
+}
 
-  for (; *pintegral != '\0'; pintegral++) {
-    PUT_CHAR(*pintegral, p);
+/**
+ * Format @p len characters of @p str escaped for JSON string (without
+ * quotes around it) according to @p s flags. Width is applied to escaped
+ * string (precision is already applied to @p len by caller).
+ */
+static size_t json(struct OUT out, size_t count, struct SPEC *s,
+    const char *str, size_t len) {
+  size_t clean, start = count;
+  char esc[6] = { '\\', 'u', '0', '0', '0', '0' };
+  unsigned char c;
+
+  if (s->width > 0 && !(s->flags & FLAG_LEFT)) {
+    s->width -= (int)json_length(str, len);
+    PAD_RIGHT(s, out, count);
   }
 
-  if (p->precision != 0 || p->is_square) { /* the '.' */
-    PUT_CHAR('.', p);
-  }
+  for (;;) {
+    clean = json_clean(str, len);
+    count = put_chars(out, count, str, clean); /* copy clean run at once */
+    if (clean == len) {
+      break;
+    }
 
-  if (*p->pf == 'g' || *p->pf == 'G') { /* smash the trailing zeros */
-    size_t i;
-    for (i = strlen(fraction); i > 0 && fraction[i - 1] == '0'; i--) {
-      fraction[i - 1] = '\0';
+    c = (unsigned char)str[clean];
+    if (c >= 0x20) {
+      esc[1] = (char)c;
+      count = put_chars(out, count, esc, 2);
+    } else if (json_controls[c] != 'u') {
+      esc[1] = json_controls[c];
+      count = put_chars(out, count, esc, 2);
+    } else {
+      esc[1] = 'u';
+      esc[4] = (char)('0' + (c >> 4));
+      esc[5] = "0123456789abcdef"[c & 0xf];
+      count = put_chars(out, count, esc, 6);
     }
-  }
-  for (; *pfraction != '\0'; pfraction++) {
-    PUT_CHAR(*pfraction, p);
+    str += clean + 1;
+    len -= clean + 1;
   }
 
-  if (*p->pf == 'g' || *p->pf == 'e') { /* the exponent put the 'e|E' */
-    PUT_CHAR('e', p);
-  } else {
-    PUT_CHAR('E', p);
+  if (s->flags & FLAG_LEFT) {
+    s->width -= (int)(count - start);
+    PAD_LEFT(s, out, count);
   }
+  return count;
+}
 
-  if (log >= 0) { /* the sign of the exp */
-    PUT_CHAR('+', p);
-  }
+/**
+ * Get amount of characters at the beginning of @p str of @p len characters
+ * which could be logfmt value without quotes (not space, control character,
+ * '=' nor '"').
+ */
+static size_t logfmt_clean(const char *str, size_t len) {
+  size_t i;
 
-  inttoa(log, 1, 2, 10, integral, sizeof(integral));
-  for (pintegral = integral; *pintegral != '\0'; pintegral++) { /* exponent */
-    PUT_CHAR(*pintegral, p);
+  for (i = 0; i < len; i++) {
+    unsigned char c = (unsigned char)str[i];
+    if (c <= ' ' || c == '=' || c == '"') {
+      break;
+    }
   }
-
-  PAD_LEFT(p);
+  return i;
 }
 
-/** Initialize and parse the conversion specifiers. */
-static void conv_flags(struct DATA *p) {
-  p->width = WIDTH_UNSET;
-  p->precision = PRECISION_UNSET;
-  p->is_star_w = p->is_star_p = 0;
-  p->is_square = p->is_space = 0;
-  p->a_long = INT_LEN_DEFAULT;
-  p->align = ALIGN_UNSET;
-  p->pad = ' ';
-  p->is_dot = 0;
-
-  for (; p != NULL && p->pf != NULL; p->pf++) {
-    switch (*p->pf) {
-      case ' ':
-        p->is_space = 1;
-        break;
+/**
+ * Format @p len characters of @p str as logfmt value: as it is if it does
+ * not need quotes, otherwise in quotes and escaped like JSON string. Width
+ * is applied to whole value (with quotes).
+ */
+static size_t quoted(struct OUT out, size_t count, struct SPEC *s,
+    const char *str, size_t len) {
+  size_t start = count;
+  int width = s->width;
 
-      case '#':
-        p->is_square = 1;
-        break;
+  if (logfmt_clean(str, len) == len) {
+    return slice(out, count, s, str, len);
+  }
 
-      case '*':
-        if (p->width == WIDTH_UNSET) {
-          p->width = 1;
-          p->is_star_w = 1;
-        } else {
-          p->precision = 1;
-          p->is_star_p = 1;
-        }
-        break;
+  if (width > 0 && !(s->flags & FLAG_LEFT)) {
+    s->width -= (int)json_length(str, len) + 2;
+    PAD_RIGHT(s, out, count);
+  }
+  s->width = WIDTH_UNSET;
 
-      case '+':
-        p->align = ALIGN_RIGHT;
-        break;
+  PUT_CHAR('"', out, count);
+  count = json(out, count, s, str, len);
+  PUT_CHAR('"', out, count);
 
-      case '-':
-        p->align = ALIGN_LEFT;
-        break;
+  if (width > 0 && (s->flags & FLAG_LEFT)) {
+    s->width = width - (int)(count - start);
+    PAD_LEFT(s, out, count);
+  }
+  return count;
+}
 
-      case '.':
-        if (p->width == WIDTH_UNSET) {
-          p->width = 0;
-        }
-        p->is_dot = 1;
-        break;
+/** Row of 16 pairs of hexadecimal digits with lower case @p h high digit. */
+#define HEX_ROW_LOWER(h)                                \
+  h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7"       \
+  h "8" h "9" h "a" h "b" h "c" h "d" h "e" h "f"
+
+/** Row of 16 pairs of hexadecimal digits with upper case @p h high digit. */
+#define HEX_ROW_UPPER(h)                                \
+  h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7"       \
+  h "8" h "9" h "A" h "B" h "C" h "D" h "E" h "F"
+
+/** Two hexadecimal digits of each byte (lower and upper case). */
+static const char hex_pairs[2][2 * 256 + 1] = {
+  HEX_ROW_LOWER("0") HEX_ROW_LOWER("1") HEX_ROW_LOWER("2") HEX_ROW_LOWER("3")
+  HEX_ROW_LOWER("4") HEX_ROW_LOWER("5") HEX_ROW_LOWER("6") HEX_ROW_LOWER("7")
+  HEX_ROW_LOWER("8") HEX_ROW_LOWER("9") HEX_ROW_LOWER("a") HEX_ROW_LOWER("b")
+  HEX_ROW_LOWER("c") HEX_ROW_LOWER("d") HEX_ROW_LOWER("e") HEX_ROW_LOWER("f"),
+  HEX_ROW_UPPER("0") HEX_ROW_UPPER("1") HEX_ROW_UPPER("2") HEX_ROW_UPPER("3")
+  HEX_ROW_UPPER("4") HEX_ROW_UPPER("5") HEX_ROW_UPPER("6") HEX_ROW_UPPER("7")
+  HEX_ROW_UPPER("8") HEX_ROW_UPPER("9") HEX_ROW_UPPER("A") HEX_ROW_UPPER("B")
+  HEX_ROW_UPPER("C") HEX_ROW_UPPER("D") HEX_ROW_UPPER("E") HEX_ROW_UPPER("F")
+};
 
-      case '0':
-        p->pad = '0';
-        if (p->is_dot) {
-          p->precision = 0;
-        }
-        break;
+/**
+ * Format @p len bytes of @p data as hexadecimal digits according to @p s
+ * flags: groups of precision bytes separated by ' ', upper case with '#'.
+ */
+static size_t hexdump(struct OUT out, size_t count, struct SPEC *s,
+    const unsigned char *data, size_t len) {
+  const char *pairs = hex_pairs[(s->flags & FLAG_SQUARE) ? 1 : 0];
+  size_t group = s->precision > 0 ? (size_t)s->precision : len, left = group;
+  const unsigned char *end = data + len;
 
-      case '1':
-      case '2':
-      case '3':
-      case '4':
-      case '5':
-      case '6':
-      case '7':
-      case '8':
-      case '9': /* get all the digits */
-        p->pf += strtoi(p->pf,
-          p->width == WIDTH_UNSET ? &p->width : &p->precision) - 1;
-        break;
+  s->width -= (int)(2 * len + (len > 0 ? (len - 1) / group : 0));
 
-      case '%':
-        return;
+  PAD_RIGHT(s, out, count);
 
-      default:
-        p->pf--; /* went to far go back */
-        return;
+  for (; data < end; data++, left--) {
+    if (left == 0) {
+      PUT_CHAR(' ', out, count);
+      left = group;
     }
+    count = put_chars(out, count, pairs + 2 * *data, 2);
   }
+
+  PAD_LEFT(s, out, count);
+  return count;
 }
 
-int vsnprintf(char *string, size_t length, const char *format, va_list args) {
-  struct DATA data;
+/** Put decimal digits of @p n byte to @p p buffer and move it after them. */
+#define PUT_BYTE_DECIMAL(p, n)                          \
+  if ((n) >= 100) {                                     \
+    *(p)++ = (char)('0' + (n) / 100);                   \
+    PUT_PAIR(p, (n) % 100);                             \
+    (p) += 2;                                           \
+  } else if ((n) >= 10) {                               \
+    PUT_PAIR(p, n);                                     \
+    (p) += 2;                                           \
+  } else {                                              \
+    *(p)++ = (char)('0' + (n));                         \
+  }
 
+/** Format IPv4 @p addr address (host order) as dotted quad to @p str. */
+static char *ipv4(char *str, unsigned long addr) {
+  unsigned int n;
+  int shift;
+
+  for (shift = 24; shift >= 0; shift -= 8) {
+    n = (unsigned int)(addr >> shift) & 0xff;
+    PUT_BYTE_DECIMAL(str, n);
+    *str++ = shift > 0 ? '.' : '\0';
+  }
+
+  return str - 1;
+}
+
+/**
+ * Format IPv6 @p addr address (16 bytes in network order) according to
+ * RFC 5952 to @p str: lower case hexadecimal digits without leading zeros,
+ * the longest (the first one) run of at least two zero groups replaced by
+ * "::" and IPv4-mapped address with dotted quad.
+ */
+static char *ipv6(char *str, const unsigned char *addr) {
+  int i, zero = -1, zeros = 1, run = 0;
+  unsigned int hi, lo;
+
+  for (i = 0; i < 8; i++) { /* find the longest run of zero groups */
+    run = (addr[2 * i] | addr[2 * i + 1]) == 0 ? run + 1 : 0;
+    if (run > zeros) {
+      zeros = run;
+      zero = i - run + 1;
+    }
+  }
+
+  if (zero == 0 && zeros == 5 && addr[10] == 0xff && addr[11] == 0xff) {
+    memcpy(str, "::ffff:", 7);
+    return ipv4(str + 7, (unsigned long)addr[12] << 24 |
+      (unsigned long)addr[13] << 16 | (unsigned long)addr[14] << 8 | addr[15]);
+  }
+
+  for (i = 0; i < 8; i++) {
+    if (i == zero) {
+      *str++ = ':';
+      if (i == 0) {
+        *str++ = ':';
+      }
+      i += zeros - 1;
+      continue;
+    }
+
+    hi = addr[2 * i];
+    lo = addr[2 * i + 1];
+    if (hi >= 0x10) {
+      memcpy(str, hex_pairs[0] + 2 * hi, 2);
+      str += 2;
+    } else if (hi > 0) {
+      *str++ = hex_pairs[0][2 * hi + 1];
+    }
+    if (hi > 0 || lo >= 0x10) {
+      memcpy(str, hex_pairs[0] + 2 * lo, 2);
+      str += 2;
+    } else {
+      *str++ = hex_pairs[0][2 * lo + 1];
+    }
+    if (i < 7) {
+      *str++ = ':';
+    }
+  }
+  *str = '\0';
+
+  return str;
+}
+
+/**
+ * Format @p addr MAC address (6 bytes) with ':' separators to @p str (upper
+ * case with '#' flag of @p s).
+ */
+static char *mac(char *str, const struct SPEC *s, const unsigned char *addr) {
+  const char *pairs = hex_pairs[(s->flags & FLAG_SQUARE) ? 1 : 0];
+  int i;
+
+  for (i = 0; i < 6; i++) {
+    memcpy(str, pairs + 2 * addr[i], 2);
+    str[2] = i < 5 ? ':' : '\0';
+    str += 3;
+  }
+
+  return str - 1;
+}
+
+#ifndef SNPRINTF_NO_LONGLONG
+/** Length of "YYYY-MM-DDTHH:MM:" prefix of timestamp. */
+#define TIME_PREFIX_SIZE      17
+
+/** Nanoseconds in second. */
+#define NANOSECONDS           1000000000LL
+
+/**
+ * Format "YYYY-MM-DDTHH:MM:" prefix of timestamp of @p minute minutes since
+ * 1970-01-01T00:00 UTC to @p str buffer.
+ */
+static void time_prefix(char *str, long long minute) {
+  long long days = minute / 1440, era;
+  unsigned int day_minute, doe, yoe, doy, mp, day, month;
+  int year;
+
+  if (minute % 1440 < 0) {
+    days--;
+  }
+  day_minute = (unsigned int)(minute - days * 1440);
+
+  /* civil date from days since epoch (proleptic Gregorian calendar) */
+  days += 719468;
+  era = (days >= 0 ? days : days - 146096) / 146097;
+  doe = (unsigned int)(days - era * 146097);
+  yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  year = (int)(yoe + era * 400) + (month <= 2);
+
+  PUT_PAIR(str, (unsigned int)year / 100 % 100);
+  PUT_PAIR(str + 2, (unsigned int)year % 100);
+  str[4] = '-';
+  PUT_PAIR(str + 5, month);
+  str[7] = '-';
+  PUT_PAIR(str + 8, day);
+  str[10] = 'T';
+  PUT_PAIR(str + 11, day_minute / 60);
+  str[13] = ':';
+  PUT_PAIR(str + 14, day_minute % 60);
+  str[16] = ':';
+}
+
+#ifdef THREAD_LOCAL
+/** The last formatted timestamp prefix of thread and its minute. */
+static THREAD_LOCAL struct {
+  long long minute;
+  char str[TIME_PREFIX_SIZE];
+} time_cache = { -1, "1969-12-31T23:59:" };
+#endif
+
+/**
+ * Format @p ns nanoseconds since 1970-01-01T00:00:00Z as ISO-8601 UTC
+ * timestamp according to @p s flags. Precision is amount of digits of
+ * fraction of second (6 by default, up to 9).
+ */
+static size_t timestamp(struct OUT out, size_t count, struct SPEC *s,
+    long long ns) {
+  char str[TIME_PREFIX_SIZE + sizeof("SS.123456789Z")], *pstr;
+  long long sec = ns / NANOSECONDS, minute;
+  long long fraction = ns % NANOSECONDS;
+  unsigned int second, frac;
+  int digits = s->precision == PRECISION_UNSET ? 6 : s->precision;
+
+  if (fraction < 0) {
+    fraction += NANOSECONDS;
+    sec--;
+  }
+  minute = sec / 60;
+  if (sec % 60 < 0) {
+    minute--;
+  }
+  second = (unsigned int)(sec - minute * 60);
+
+#ifdef THREAD_LOCAL
+  if (time_cache.minute != minute) { /* only once per minute */
+    time_prefix(time_cache.str, minute);
+    time_cache.minute = minute;
+  }
+  memcpy(str, time_cache.str, TIME_PREFIX_SIZE);
+#else
+  time_prefix(str, minute);
+#endif
+
+  pstr = str + TIME_PREFIX_SIZE;
+  PUT_PAIR(pstr, second);
+  pstr += 2;
+
+  if (digits > 0) {
+    *pstr++ = '.';
+    frac = (unsigned int)fraction;
+    pstr[8] = (char)('0' + frac % 10);
+    frac /= 10;
+    PUT_PAIR(pstr + 6, frac % 100);
+    frac /= 100;
+    PUT_PAIR(pstr + 4, frac % 100);
+    frac /= 100;
+    PUT_PAIR(pstr + 2, frac % 100);
+    PUT_PAIR(pstr, frac / 100);
+    pstr += digits > 9 ? 9 : digits; /* truncated, not rounded */
+  }
+
+  *pstr++ = 'Z';
+  *pstr = '\0';
+
+  s->pad = ' ';
+  s->precision = PRECISION_UNSET;
+  return strings(out, count, s, str);
+}
+
+/** Maximum of significant digits of human readable size. */
+#define MAX_SIZE_DIGITS       18
+
+/**
+ * Format @p v amount of bytes as human readable size ("12.3 MB") according
+ * to @p s flags: decimal (SI) units or binary units with '#' and precision
+ * as amount of significant digits (3 by default). Integer arithmetic only.
+ */
+static size_t human_size(struct OUT out, size_t count, struct SPEC *s,
+    unsigned long long v) {
+  static const char units[2][7][4] = {
+    { "B", "kB", "MB", "GB", "TB", "PB", "EB" },
+    { "B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB" }
+  };
+  int binary = (s->flags & FLAG_SQUARE) != 0, unit = 0, decimals, i;
+  int digits = s->precision == PRECISION_UNSET ? 3 : s->precision;
+  unsigned long long base = binary ? 1024 : 1000, d = 1, q, rem, p10;
+  char str[MAX_SIZE_DIGITS + 2 + sizeof(" KiB")], *pstr;
+
+  if (digits < 1) {
+    digits = 1;
+  } else if (digits > MAX_SIZE_DIGITS) {
+    digits = MAX_SIZE_DIGITS;
+  }
+
+  for (; unit < 6 && v / d >= base; unit++) {
+    d *= base;
+  }
+
+  for (;;) {
+    q = v / d;
+    rem = v % d;
+
+    decimals = 0;
+    if (unit > 0) { /* digits of fraction up to significant digits */
+      for (decimals = digits - 1, p10 = 10; p10 <= q; p10 *= 10) {
+        decimals--;
+      }
+      decimals = decimals < 0 ? 0 : decimals;
+    }
+
+    for (i = 0, p10 = 1; i < decimals; i++, p10 *= 10) { /* long division */
+      rem *= 10;
+      q = q * 10 + rem / d;
+      rem %= d;
+    }
+    if (rem >= d - rem) { /* round half up */
+      q++;
+    }
+
+    if (unit == 6 || q / p10 < base) {
+      break;
+    }
+    d *= base; /* rounded up to the next unit */
+    unit++;
+  }
+
+  pstr = str + MAX_SIZE_DIGITS + 2;
+  pstr[0] = ' ';
+  memcpy(pstr + 1, units[binary][unit], sizeof(units[0][0]));
+
+  for (i = 0; q != 0 || i <= decimals; i++, q /= 10) {
+    if (i == decimals && decimals > 0) {
+      *--pstr = '.';
+    }
+    *--pstr = (char)('0' + q % 10);
+  }
+
+  s->pad = ' ';
+  s->precision = PRECISION_UNSET;
+  return strings(out, count, s, pstr);
+}
+#endif
+
+#ifndef SNPRINTF_NO_FLOAT
+/** Format infinity or not a number (@p is_nan) according to @p s flags. */
+static size_t special(struct OUT out, size_t count, struct SPEC *s,
+    int is_negative, int is_nan) {
+  char str[5], *pstr = str, sign = sign_char(s, is_negative);
+  const char *name = is_nan ? "nan" : "inf";
+
+  if (sign != '\0') {
+    *pstr++ = sign;
+  }
+  for (; *name != '\0'; name++) {
+    *pstr++ = isupper(s->conv) ? (char)toupper(*name) : *name;
+  }
+  *pstr = '\0';
+
+  s->pad = ' ';
+  s->precision = PRECISION_UNSET;
+  return strings(out, count, s, str);
+}
+#endif
+
+/** Get digit of @p i position of @p n @p digits (0 outside of them). */
+#define DIGIT_AT(digits, n, i)                          \
+  ((i) >= 0 && (i) < (n) ? (digits)[i] : '0')
+
+/** Padding right optionally with @p sign character (zeros after it). */
+#define PAD_RIGHT_SIGN(sign, s, out, count)             \
+  if ((s)->pad != '0') {                                \
+    PAD_RIGHT(s, out, count);                           \
+  }                                                     \
+  if ((sign) != '\0') {                                 \
+    PUT_CHAR((sign), out, count);                       \
+  }                                                     \
+  if ((s)->pad == '0') {                                \
+    PAD_RIGHT(s, out, count);                           \
+  }
+
+/**
+ * Format number given by decimal @p digits as ASCII decimal floating point
+ * according to @p s flags.
+ *
+ * @param out Output of formatting.
+ * @param count Amount of characters already put to @p out.
+ * @param s Specification of field.
+ * @param is_negative Is number negative?
+ * @param digits Significant digits of number (@see decompose()).
+ * @param n Amount of @p digits.
+ * @param exp Decimal exponent of the first digit.
+ *
+ * @return Amount of characters put to @p out (with @p count).
+ */
+static size_t floating(struct OUT out, size_t count, struct SPEC *s,
+    int is_negative, const char *digits, int n, int exp) {
+  char sign = sign_char(s, is_negative);
+  int i, integral = exp >= 0 ? exp + 1 : 1; /* digits before the '.' */
+
+  s->width -= (sign != '\0') + integral + s->precision;
+  if (s->precision != 0 || (s->flags & FLAG_SQUARE)) { /* 1 for the dot */
+    s->width -= 1;
+  }
+
+  PAD_RIGHT_SIGN(sign, s, out, count);
+
+  for (i = exp - integral + 1; i <= exp; i++) {
+    PUT_CHAR(DIGIT_AT(digits, n, i), out, count);
+  }
+
+  if (s->precision != 0 || (s->flags & FLAG_SQUARE)) { /* put the '.' */
+    PUT_CHAR('.', out, count);
+  }
+
+  for (; i <= exp + s->precision; i++) {
+    PUT_CHAR(DIGIT_AT(digits, n, i), out, count);
+  }
+
+  PAD_LEFT(s, out, count);
+  return count;
+}
+
+#ifndef SNPRINTF_NO_FLOAT
+/** 
+ * Format number given by decimal @p digits as ASCII scientific (exponential)
+ * floating point according to @p s flags.
+ *
+ * @see floating()
+ */
+static size_t exponent(struct OUT out, size_t count, struct SPEC *s,
+    int is_negative, const char *digits, int n, int exp) {
+  char sign = sign_char(s, is_negative), number[8], *pnumber = number;
+  int i;
+
+  inttoa(exp, 1, 2, 10, '\0', number, sizeof(number));
+
+  /* 1 for unit, 1 for the '.', 1 for 'e|E', 1 for '+|-', 2 for 'exp' */
+  s->width -= (sign != '\0') + 1 + s->precision + 1 + (exp >= 0) +
+    (int)strlen(number);
+  if (s->precision != 0 || (s->flags & FLAG_SQUARE)) {
+    s->width -= 1;
+  }
+
+  PAD_RIGHT_SIGN(sign, s, out, count);
+
+  PUT_CHAR(DIGIT_AT(digits, n, 0), out, count);
+
+  if (s->precision != 0 || (s->flags & FLAG_SQUARE)) { /* the '.' */
+    PUT_CHAR('.', out, count);
+  }
+
+  for (i = 1; i <= s->precision; i++) {
+    PUT_CHAR(DIGIT_AT(digits, n, i), out, count);
+  }
+
+  /* the exponent put the 'e|E' */
+  PUT_CHAR(s->conv == 'E' || s->conv == 'G' ? 'E' : 'e', out, count);
+
+  if (exp >= 0) { /* the sign of the exp */
+    PUT_CHAR('+', out, count);
+  }
+
+  for (; *pnumber != '\0'; pnumber++) { /* exponent */
+    PUT_CHAR(*pnumber, out, count);
+  }
+
+  PAD_LEFT(s, out, count);
+  return count;
+}
+
+/** Maximum amount of significant digits taken from double. */
+#define MAX_DOUBLE_DIGITS     17
+
+/** Powers of 10 up to 10^MAX_DOUBLE_DIGITS. */
+static const unsigned long long pow_10_integer[MAX_DOUBLE_DIGITS + 1] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+  1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL
+};
+
+/**
+ * Split positive @p d into significand m and binary exponent @p e2, such that
+ * d = m * 2^e2 (m has 53 bits, less for subnormal number).
+ */
+static unsigned long long split_double(double d, int *e2) {
+  unsigned long long bits, m;
+
+  memcpy(&bits, &d, sizeof(bits));
+  m = bits & ((1ull << 52) - 1);
+  *e2 = (int)(bits >> 52);
+  if (*e2 != 0) {
+    m |= 1ull << 52;
+  } else { /* subnormal number */
+    *e2 = 1;
+  }
+  *e2 -= 1075;
+
+  return m;
+}
+
+/**
+ * Decimal exponent of the first digit of positive @p d - floor(log10(d)).
+ * It is floor(log10(2^p)) or one more for d in [2^p, 2^(p+1)), the latter
+ * when d >= 10^q (q = floor(log10(2^p)) + 1). Only if 10^q is in the same
+ * binary exponent, significands are compared - the highest bits of 5^q.
+ */
+static int exponent_10(double d) {
+  unsigned long long m;
+  int e2, lz, p, e;
+
+  m = split_double(d, &e2);
+  lz = leading_zeros(m);
+  p = 63 - lz + e2; /* 2^p <= d < 2^(p+1) */
+  e = FLOOR_LOG10_2(p);
+
+  if (FLOOR_LOG2_10(e + 1) == p) {
+    const unsigned long long *pow_5 = pow_5_128 + 2 * (e + 1 - POW_5_MIN);
+
+    /* 5^q is exact for q <= 55, otherwise rounded (d is not 10^q) */
+    if ((m << lz) > pow_5[0] ||
+        ((m << lz) == pow_5[0] && pow_5[1] == 0 && e + 1 <= 55)) {
+      e++;
+    }
+  }
+
+  return e;
+}
+/** Is d = @p m * 2^@p e2 exactly halfway: (@p u + 0.5) * 10^@p j? */
+static int is_halfway(unsigned long long m, int e2, unsigned long long u,
+    int j) {
+  unsigned long long p = 1, high;
+  int i;
+
+  if (j > 22) { /* 5^j does not divide 53 bits of significand */
+    return 0;
+  }
+
+  for (; (m & 1) == 0; m >>= 1) {
+    e2++;
+  }
+  for (i = 0; i < j; i++) {
+    p *= 5;
+  }
+
+  /* 2 * m * 2^e2 == (2u + 1) * 5^j * 2^j with odd m */
+  return e2 + 1 == j && multiply_64(2 * u + 1, p, &high) == m && high == 0;
+}
+
+/**
+ * Return @p d * 10^@p k rounded to integer (half to even). Significand of
+ * @p d is multiplied by 128 bits of 5^k, so the product has error less
+ * than its lowest 64-bit word. Only when the rest is that close to half,
+ * the exact product (0 <= k <= 55) or exact check of halfway decides.
+ *
+ * @param d Positive number.
+ * @param k Decimal exponent such that result is less then 10^MAX_DOUBLE_DIGITS.
+ */
+static unsigned long long scale(double d, int k) {
+  const unsigned long long *pow_5 = pow_5_128 + 2 * (k - POW_5_MIN);
+  unsigned long long m, high, middle, low, second, u, rest, half;
+  int e2, lz, r, is_up;
+
+  m = split_double(d, &e2); /* d = m * 2^e2 */
+
+  /* high:middle:low = (m << lz) * 5^k * 2^(127 - floor(log2(5^k))) */
+  lz = leading_zeros(m);
+  middle = multiply_64(m << lz, pow_5[0], &high);
+  low = multiply_64(m << lz, pow_5[1], &second);
+  middle += second;
+  high += middle < second;
+
+  /* d * 10^k = high * 2^-r + the rest */
+  r = lz - e2 - FLOOR_LOG2_10(k) - 1;
+  if (r > 64) { /* less than 0.5 */
+    return 0;
+  }
+  u = r < 64 ? high >> r : 0;
+  rest = r < 64 ? high & ((1ull << r) - 1) : high;
+  half = 1ull << (r - 1);
+
+  if (rest > half || (rest == half && middle != 0)) {
+    is_up = 1;
+  } else if (rest < half - 1 || (rest == half - 1 && middle != ~0ull)) {
+    is_up = 0;
+  } else if (k >= 0 && k <= 55) { /* 5^k is exact, so is the product */
+    is_up = rest == half && (low != 0 || (u & 1));
+  } else if (k < 0) { /* 5^k is rounded up */
+    is_up = rest == half && low != 0 &&
+      (!is_halfway(m, e2, u, -k) || (u & 1));
+  } else { /* 5^k is truncated, there are no ties */
+    is_up = rest == half;
+  }
+
+  return u + (unsigned long long)is_up;
+}
+
+/**
+ * Decompose @p d number into significant decimal @p digits and decimal
+ * exponent @p exp of the first digit (d ~= d(0).d(1)d(2)... * 10^exp).
+ * Number is rounded only once - to @p n significant digits or, if
+ * @p is_fixed is set, to @p n digits after the decimal point.
+ *
+ * @param d Finite and not negative number.
+ * @param n Amount of digits (@see is_fixed).
+ * @param is_fixed Count @p n digits from the decimal point?
+ * @param digits Buffer for MAX_DOUBLE_DIGITS digits (without '\0').
+ * @param exp Output decimal exponent of the first digit.
+ *
+ * @return Amount of digits put in @p digits (0 if number is rounded to 0).
+ */
+static int decompose(double d, int n, int is_fixed, char *digits, int *exp) {
+  unsigned long long u;
+  int e, i;
+
+  *exp = 0;
+  if (d == 0.) {
+    return 0;
+  }
+
+  e = exponent_10(d);
+  if (is_fixed) {
+    n += e + 1;
+  }
+  if (n < 0) {
+    return 0;
+  }
+  n = n > MAX_DOUBLE_DIGITS ? MAX_DOUBLE_DIGITS : n;
+
+  u = scale(d, n - 1 - e);
+  if (u == 0) {
+    return 0;
+  }
+  if (u >= pow_10_integer[n]) { /* carry into the next decade */
+    e++;
+    if (n > 0) {
+      u /= 10;
+    } else {
+      n = 1;
+    }
+  }
+
+  for (i = n; i > 0; i--, u /= 10) {
+    digits[i - 1] = (char)(u % 10) + '0';
+  }
+
+  *exp = e;
+  return n;
+}
+
+/**
+ * Format @p d floating point number as ASCII decimal (%f), scientific (%e)
+ * or, depending of exponent, one of them (%g) according to @p s flags.
+ */
+static size_t real(struct OUT out, size_t count, struct SPEC *s, double d) {
+  char digits[MAX_DOUBLE_DIGITS];
+  unsigned long long bits;
+  int n, exp, is_negative;
+
+  memcpy(&bits, &d, sizeof(bits));
+  is_negative = (int)(bits >> 63); /* also of -0 and -nan */
+
+  if (d != d || d - d != d - d) { /* not a number or infinity */
+    return special(out, count, s, is_negative, d != d);
+  }
+
+  d = is_negative ? -d : d;
+
+  switch (s->conv) {
+    case 'f':
+    case 'F':
+      n = decompose(d, s->precision, 1, digits, &exp);
+      return floating(out, count, s, is_negative, digits, n, exp);
+
+    case 'e':
+    case 'E':
+      n = decompose(d, s->precision + 1, 0, digits, &exp);
+      return exponent(out, count, s, is_negative, digits, n, exp);
+
+    default: { /* 'g' or 'G' */
+      int precision = s->precision == 0 ? 1 : s->precision;
+      int is_square = (s->flags & FLAG_SQUARE) != 0;
+
+      n = decompose(d, precision, 0, digits, &exp);
+      if (!is_square) { /* smash the trailing zeros */
+        for (; n > 0 && digits[n - 1] == '0'; n--) {}
+      }
+
+      /* use decimal floating point (%f / %F) if exponent is in the range
+         [-4,precision) else use scientific floating point (%e / %E) */
+      if (-4 <= exp && exp < precision) {
+        s->precision = is_square ? precision - 1 - exp : n - 1 - exp;
+        s->precision = s->precision < 0 ? 0 : s->precision;
+        return floating(out, count, s, is_negative, digits, n, exp);
+      }
+
+      s->precision = is_square ? precision - 1 : n - 1;
+      s->precision = s->precision < 0 ? 0 : s->precision;
+      return exponent(out, count, s, is_negative, digits, n, exp);
+    }
+  }
+}
+
+/** Hexadecimal digits in lower and upper case. */
+static const char hex_digits[2][16] = {
+  { '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' },
+  { '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' }
+};
+
+/** Amount of hexadecimal digits of fraction part of IEEE-754 double. */
+#define HEX_FRACTION_DIGITS   13
+
+/**
+ * Format @p d floating point number as ASCII hexadecimal floating point
+ * according to @p s flags.
+ *
+ * @note Number is taken directly from bit pattern of IEEE-754 double,
+ *    so output is exact and there is no decimal conversion at all.
+ */
+static size_t hexfloat(struct OUT out, size_t count, struct SPEC *s,
+    double d) {
+  char sign, exp[8];
+  const char *digits = hex_digits[s->conv == 'A'];
+  unsigned long long bits, fraction;
+  int e, lead, n, zeros = 0;
+
+  memcpy(&bits, &d, sizeof(bits));
+  fraction = bits & ((1ull << 52) - 1);
+  e = (int)(bits >> 52) & 0x7ff;
+
+  if (e == 0x7ff) { /* infinity or not a number */
+    return special(out, count, s, (int)(bits >> 63), fraction != 0);
+  }
+
+  sign = sign_char(s, (int)(bits >> 63));
+
+  if (e == 0) { /* zero or subnormal number */
+    lead = 0;
+    e = fraction != 0 ? -1022 : 0;
+  } else {
+    lead = 1;
+    e -= 1023;
+  }
+
+  n = s->precision;
+  if (n == PRECISION_UNSET) { /* as many digits as needed for exact value */
+    for (n = HEX_FRACTION_DIGITS; n > 0 && (fraction & 0xf) == 0; n--) {
+      fraction >>= 4;
+    }
+  } else if (n < HEX_FRACTION_DIGITS) { /* round half to even */
+    int shift = (HEX_FRACTION_DIGITS - n) * 4;
+    unsigned long long rest = fraction & ((1ull << shift) - 1);
+    unsigned long long half = 1ull << (shift - 1);
+
+    fraction >>= shift;
+    if (rest > half || (rest == half && ((n > 0 ? fraction : (unsigned long long)lead) & 1))) {
+      fraction++;
+      if (fraction >> (n * 4)) { /* carry into leading digit */
+        fraction &= (1ull << (n * 4)) - 1;
+        lead++;
+      }
+    }
+  } else {
+    zeros = n - HEX_FRACTION_DIGITS;
+    n = HEX_FRACTION_DIGITS;
+  }
+
+  inttoa(e, 1, 1, 10, '\0', exp, sizeof(exp));
+
+  /* '0x', leading digit, '.', digits, 'p', sign of exponent, exponent */
+  s->width -= (sign != '\0') + 3 + (n + zeros > 0 || (s->flags & FLAG_SQUARE)) +
+    n + zeros + 1 + (e >= 0) + (int)strlen(exp);
+
+  if (s->pad != '0') {
+    PAD_RIGHT(s, out, count);
+  }
+
+  if (sign != '\0') {
+    PUT_CHAR(sign, out, count);
+  }
+  PUT_CHAR('0', out, count);
+  PUT_CHAR(s->conv == 'A' ? 'X' : 'x', out, count);
+
+  if (s->pad == '0') { /* zeros between prefix and digits */
+    PAD_RIGHT(s, out, count);
+  }
+
+  PUT_CHAR(digits[lead], out, count);
+  if (n + zeros > 0 || (s->flags & FLAG_SQUARE)) {
+    PUT_CHAR('.', out, count);
+  }
+  for (n = (n - 1) * 4; n >= 0; n -= 4) {
+    PUT_CHAR(digits[(fraction >> n) & 0xf], out, count);
+  }
+  for (; zeros > 0; zeros--) {
+    PUT_CHAR('0', out, count);
+  }
+
+  PUT_CHAR(s->conv == 'A' ? 'P' : 'p', out, count);
+  if (e >= 0) {
+    PUT_CHAR('+', out, count);
+  }
+  for (n = 0; exp[n] != '\0'; n++) {
+    PUT_CHAR(exp[n], out, count);
+  }
+
+  PAD_LEFT(s, out, count);
+  return count;
+}
+
+#endif
+
+/** Maximum size of the buffer for the exact fraction part of fixed point. */
+#define MAX_FIXED_FRACTION_SIZE (LONGEST_BITS - 4 + 1)
+
+/**
+ * Format fixed point number as ASCII decimal floating point according to
+ * @p s flags. Only integer arithmetic is used.
+ *
+ * @param out Output of formatting.
+ * @param count Amount of characters already put to @p out.
+ * @param s Specification of field.
+ * @param is_negative Is number negative?
+ * @param ip Absolute value of integral part of number.
+ * @param fraction Exact fraction digits of number.
+ *
+ * @return Amount of characters put to @p out (with @p count).
+ */
+static size_t fixed(struct OUT out, size_t count, struct SPEC *s,
+    int is_negative, unsigned LONGEST ip, char *fraction) {
+  char digits[MAX_INTEGRAL_SIZE];
+  int i = (int)strlen(fraction), n;
+
+  if (s->precision < i) { /* round off to the precision */
+    const char *rest = fraction + s->precision + 1;
+    int carry = fraction[s->precision] > '5';
+
+    if (fraction[s->precision] == '5') { /* exact tie is rounded to even */
+      for (; *rest == '0'; rest++) {}
+      carry = *rest != '\0' || ((s->precision > 0 ?
+        (unsigned LONGEST)fraction[s->precision - 1] : ip) & 1);
+    }
+    for (i = s->precision; carry && i > 0; i--) {
+      if (fraction[i - 1] == '9') {
+        fraction[i - 1] = '0';
+      } else {
+        fraction[i - 1]++;
+        carry = 0;
+      }
+    }
+    ip += (unsigned LONGEST)carry;
+    i = s->precision;
+  }
+
+  inttoa((LONGEST)ip, 0, 1, 10, '\0', digits, sizeof(digits));
+  n = (int)strlen(digits);
+  memcpy(digits + n, fraction, (size_t)i);
+
+  return floating(out, count, s, is_negative, digits, n + i, n - 1);
+}
+
+/**
+ * Format @p ll number as fixed point number according to @p s flags.
+ *
+ * Conversion character SPEC::conv decides about meaning of @p scale:
+ *  - k / K: binary fixed point (Q format) with @p scale fraction bits,
+ *  - r / R: decimal fixed point with @p scale fraction decimal digits.
+ */
+static size_t fixed_point(struct OUT out, size_t count, struct SPEC *s,
+    int scale, LONGEST ll) {
+  char fraction[MAX_FIXED_FRACTION_SIZE];
+  int is_negative = (s->conv == 'k' || s->conv == 'r') && ll < 0;
+  unsigned LONGEST n = is_negative ?
+    0u - (unsigned LONGEST)ll : (unsigned LONGEST)ll;
+  unsigned LONGEST ip = 0;
+  int i = 0;
+
+  scale = scale < 0 ? 0 : scale;
+
+  if (s->conv == 'k' || s->conv == 'K') {
+    unsigned LONGEST mask;
+
+    scale = scale > LONGEST_BITS - 1 ? LONGEST_BITS - 1 : scale;
+    ip = n >> scale;
+    if (scale > MAX_FIXED_FRACTION_SIZE - 1) { /* (n * 10) must not overflow */
+      n >>= scale - (MAX_FIXED_FRACTION_SIZE - 1);
+      scale = MAX_FIXED_FRACTION_SIZE - 1;
+    }
+    mask = ((unsigned LONGEST)1 << scale) - 1;
+    for (n &= mask; i < scale; i++) {
+      n *= 10;
+      fraction[i] = (char)(n >> scale) + '0';
+      n &= mask;
+    }
+  } else {
+    scale = scale > MAX_FIXED_FRACTION_SIZE - 1 ?
+      MAX_FIXED_FRACTION_SIZE - 1 : scale;
+    for (i = scale; i > 0; i--, n /= 10) {
+      fraction[i - 1] = (char)(n % 10) + '0';
+    }
+    ip = n;
+    i = scale;
+  }
+  fraction[i] = '\0';
+
+  return fixed(out, count, s, is_negative, ip, fraction);
+}
+
+/** Get the next tagged argument (0 integer if there is no more). */
+static const struct snprintf_arg *arg_next(struct ARGS *args) {
+  static const struct snprintf_arg none = { SNPRINTF_ARG_INT, { 0 } };
+
+  return args->next < args->size ? &args->vector[args->next++] : &none;
+}
+
+/** Convert @p a tagged argument to integer. */
+static unsigned long long arg_to_integer(const struct snprintf_arg *a) {
+  switch (a->type) {
+    case SNPRINTF_ARG_INT:
+      return (unsigned long long)a->value.i;
+    case SNPRINTF_ARG_UINT:
+      return a->value.u;
+    case SNPRINTF_ARG_DOUBLE: /* cast out of range is undefined */
+      return a->value.d > -9.2e18 && a->value.d < 9.2e18 ?
+        (unsigned long long)(long long)a->value.d : 0;
+    case SNPRINTF_ARG_POINTER:
+      return (unsigned long long)(size_t)a->value.p;
+    default:
+      return 0;
+  }
+}
+
+/** Get the next tagged argument converted to integer. */
+static unsigned long long arg_integer(struct ARGS *args) {
+  return arg_to_integer(arg_next(args));
+}
+
+#ifdef SNPRINTF_INT128
+/** Get the next tagged argument converted to 128-bit integer. */
+static INT128 arg_int128(struct ARGS *args) {
+  const struct snprintf_arg *a = arg_next(args);
+
+  if (a->type == SNPRINTF_ARG_UINT) {
+    return (INT128)a->value.u;
+  }
+  return (INT128)(long long)arg_to_integer(a);
+}
+#endif
+
+/** Get the next tagged argument converted to floating point number. */
+static double arg_double(struct ARGS *args) {
+  const struct snprintf_arg *a = arg_next(args);
+
+  switch (a->type) {
+    case SNPRINTF_ARG_DOUBLE:
+      return a->value.d;
+    case SNPRINTF_ARG_INT:
+      return (double)a->value.i;
+    case SNPRINTF_ARG_UINT:
+      return (double)a->value.u;
+    default:
+      return 0.0;
+  }
+}
+
+/** Get the next tagged argument as writable pointer (NULL if it is not). */
+static void *arg_pointer(struct ARGS *args) {
+  const struct snprintf_arg *a = arg_next(args);
+
+  return a->type == SNPRINTF_ARG_POINTER ? a->value.p : NULL;
+}
+
+/** Get the next tagged argument as pointer to data (pointer or string). */
+static const void *arg_data(struct ARGS *args) {
+  const struct snprintf_arg *a = arg_next(args);
+
+  if (a->type == SNPRINTF_ARG_STRING) {
+    return a->value.s.str;
+  }
+  return a->type == SNPRINTF_ARG_POINTER ? a->value.p : NULL;
+}
+
+/**
+ * Get the next tagged argument as string and its @p len length (not more
+ * than @p precision if it is '\0' terminated). Empty string if it is not.
+ */
+static const char *arg_string(struct ARGS *args, int precision,
+    size_t *len) {
+  const struct snprintf_arg *a = arg_next(args);
+
+  if (a->type == SNPRINTF_ARG_STRING && a->value.s.str != NULL) {
+    *len = a->value.s.len;
+    return a->value.s.str;
+  } else if (a->type == SNPRINTF_ARG_POINTER && a->value.p != NULL) {
+    *len = string_length((const char *)a->value.p, precision);
+    return (const char *)a->value.p;
+  }
+
+  *len = 0;
+  return "";
+}
+
+/**
+ * Get the next tagged argument as pointer to data and its @p len length:
+ * string or pointer followed by integer length.
+ */
+static const void *arg_sized(struct ARGS *args, size_t *len) {
+  const struct snprintf_arg *a = arg_next(args);
+
+  if (a->type == SNPRINTF_ARG_STRING) {
+    *len = a->value.s.len;
+    return a->value.s.str;
+  } else if (a->type == SNPRINTF_ARG_POINTER) {
+    *len = (size_t)arg_integer(args);
+    return a->value.p;
+  }
+
+  *len = 0;
+  return NULL;
+}
+
+#if defined(SNPRINTF_NO_FLOAT) || defined(SNPRINTF_NO_LONGLONG) || \
+    defined(SNPRINTF_NO_OCTAL) || defined(SNPRINTF_NO_N)
+/** Put SNPRINTF_PLACEHOLDER instead of conversion removed from build. */
+static size_t placeholder(struct OUT out, size_t count, struct SPEC *s) {
+  s->pad = ' ';
+  s->precision = PRECISION_UNSET;
+  return strings(out, count, s, SNPRINTF_PLACEHOLDER);
+}
+#endif
+
+#ifdef __GNUC__
+/** Conversion is inlined into both of its instances (@see CONVERSION). */
+#define CONVERSION_INLINE     static inline __attribute__((always_inline))
+#else
+#define CONVERSION_INLINE     static inline
+#endif
+
+#ifdef SNPRINTF_NO_LONGLONG
+/**
+ * Skip "long long" argument (after @p ints int arguments) and put placeholder
+ * instead of it.
+ */
+#define LONG_LONG_UNSUPPORTED(s, ints)                  \
+  if ((s)->length == INT_LEN_LONG_LONG) {               \
+    int i;                                              \
+    WIDTH_AND_PRECISION_ARGS(s);                        \
+    for (i = 0; i < (ints); i++) {                      \
+      (void)ARG(args, int, integer);                    \
+    }                                                   \
+    (void)ARG(args, long long, integer);                \
+    return placeholder(out, count, s);                  \
+  }
+#else
+#define LONG_LONG_UNSUPPORTED(s, ints)
+#endif
+
+#ifdef SNPRINTF_INT128
+/** Format 128-bit integer argument in @p base (w128 length). */
+CONVERSION_INLINE size_t conv_int128(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int base, int is_vector) {
+  INT128 v;
+  WIDTH_AND_PRECISION_ARGS(s);
+  v = ARG(args, INT128, int128);
+#ifdef SNPRINTF_NO_OCTAL
+  if (base == 8) {
+    return placeholder(out, count, s);
+  }
+#endif
+  if ((s->conv == 'd' || s->conv == 'i') && v < 0) {
+    return integer128(out, count, s, base, -(UINT128)v, 1);
+  }
+  return integer128(out, count, s, base, (UINT128)v, 0);
+}
+
+/** Format 128-bit integer argument in @p base if requested by length. */
+#define INT128_CONVERSION(s, base)                      \
+  if ((s)->length == INT_LEN_INT128) {                  \
+    return conv_int128(out, count, s, args, base, is_vector); \
+  }
+#else
+#define INT128_CONVERSION(s, base)
+#endif
+
+/** Format floating point number (%f, %e, %g). */
+CONVERSION_INLINE size_t conv_real(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  double d;
+  DOUBLE_ARG(s, d);
+#ifndef SNPRINTF_NO_FLOAT
+  return real(out, count, s, d);
+#else
+  (void)d;
+  return placeholder(out, count, s);
+#endif
+}
+
+/** Format floating point number as hexadecimal (%a). */
+CONVERSION_INLINE size_t conv_hexfloat(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  double d;
+  WIDTH_AND_PRECISION_ARGS(s);
+  d = ARG(args, double, double);
+#ifndef SNPRINTF_NO_FLOAT
+  return hexfloat(out, count, s, d);
+#else
+  (void)d;
+  return placeholder(out, count, s);
+#endif
+}
+
+/** Format signed (%k, %r) or unsigned (%K, %R) fixed point number. */
+CONVERSION_INLINE size_t conv_fixed(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  int scale;
+  LONGEST ll;
+  LONG_LONG_UNSUPPORTED(s, 1);
+  if (s->conv == 'k' || s->conv == 'r') {
+    FIXED_ARG(s, signed, scale, ll);
+  } else {
+    FIXED_ARG(s, unsigned, scale, ll);
+  }
+  return fixed_point(out, count, s, scale, ll);
+}
+
+/** Format signed (%d, %i) or unsigned (%u) decimal integer. */
+CONVERSION_INLINE size_t conv_decimal(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  LONGEST ll;
+  LONG_LONG_UNSUPPORTED(s, 0);
+  INT128_CONVERSION(s, 10);
+  if (s->conv == 'u') {
+    INTEGER_ARG(s, unsigned, ll);
+  } else {
+    INTEGER_ARG(s, signed, ll);
+  }
+  return decimal(out, count, s, ll);
+}
+
+/** Format octal integer (always unsigned). */
+CONVERSION_INLINE size_t conv_octal(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  LONGEST ll;
+  LONG_LONG_UNSUPPORTED(s, 0);
+  INT128_CONVERSION(s, 8);
+  INTEGER_ARG(s, unsigned, ll);
+#ifndef SNPRINTF_NO_OCTAL
+  return octal(out, count, s, ll);
+#else
+  (void)ll;
+  return placeholder(out, count, s);
+#endif
+}
+
+/** Format hexadecimal integer (always unsigned). */
+CONVERSION_INLINE size_t conv_hex(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  LONGEST ll;
+  LONG_LONG_UNSUPPORTED(s, 0);
+  INT128_CONVERSION(s, 16);
+  INTEGER_ARG(s, unsigned, ll);
+  return hex(out, count, s, ll);
+}
+
+/** Format binary integer (always unsigned). */
+CONVERSION_INLINE size_t conv_binary(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  LONGEST ll;
+  LONG_LONG_UNSUPPORTED(s, 0);
+  INTEGER_ARG(s, unsigned, ll);
+  return binary(out, count, s, ll);
+}
+
+/** Format single character (also '\0') in field of width. */
+CONVERSION_INLINE size_t conv_char(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  char c;
+  WIDTH_AND_PRECISION_ARGS(s);
+  c = (char)ARG(args, int, integer);
+  s->precision = PRECISION_UNSET;
+  return slice(out, count, s, &c, 1);
+}
+
+/** Format string of characters. */
+CONVERSION_INLINE size_t conv_string(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  const char *str;
+  size_t len;
+  WIDTH_AND_PRECISION_ARGS(s);
+  STRING_ARG(s, str, len);
+  return slice(out, count, s, str, len);
+}
+
+/** Format string of characters given by pointer and length. */
+CONVERSION_INLINE size_t conv_slice(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  const char *str;
+  size_t len;
+  WIDTH_AND_PRECISION_ARGS(s);
+  SIZED_ARG(const char *, str, len);
+  return slice(out, count, s, str, len);
+}
+
+/** Format string of characters escaped for JSON string. */
+CONVERSION_INLINE size_t conv_json(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  const char *str;
+  size_t len;
+  WIDTH_AND_PRECISION_ARGS(s);
+  STRING_ARG(s, str, len);
+  return json(out, count, s, str, len);
+}
+
+/** Format string of characters as logfmt value (quoted if it is needed). */
+CONVERSION_INLINE size_t conv_quoted(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  const char *str;
+  size_t len;
+  WIDTH_AND_PRECISION_ARGS(s);
+  STRING_ARG(s, str, len);
+  return quoted(out, count, s, str, len);
+}
+
+/** Format buffer of bytes (pointer and length) as hexadecimal digits. */
+CONVERSION_INLINE size_t conv_hexdump(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  const unsigned char *data;
+  size_t len;
+  WIDTH_AND_PRECISION_ARGS(s);
+  SIZED_ARG(const unsigned char *, data, len);
+  return hexdump(out, count, s, data, len);
+}
+
+/** Format timestamp given by nanoseconds since 1970-01-01T00:00:00Z. */
+CONVERSION_INLINE size_t conv_timestamp(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  long long ns;
+  WIDTH_AND_PRECISION_ARGS(s);
+  ns = ARG(args, long long, integer);
+#ifndef SNPRINTF_NO_LONGLONG
+  return timestamp(out, count, s, ns);
+#else
+  (void)ns;
+  return placeholder(out, count, s);
+#endif
+}
+
+/** Format amount of bytes as human readable size. */
+CONVERSION_INLINE size_t conv_size(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  unsigned long long v;
+  WIDTH_AND_PRECISION_ARGS(s);
+  v = ARG(args, unsigned long long, integer);
+#ifndef SNPRINTF_NO_LONGLONG
+  return human_size(out, count, s, v);
+#else
+  (void)v;
+  return placeholder(out, count, s);
+#endif
+}
+
+/**
+ * Format network address: IPv4 (%I, %I4) from unsigned int in host order,
+ * IPv6 (%I6) or MAC (%M) from pointer to bytes in network order.
+ */
+CONVERSION_INLINE size_t conv_address(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  char str[sizeof("ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255")];
+  WIDTH_AND_PRECISION_ARGS(s);
+  if (s->conv == 'M') {
+    mac(str, s, ARG(args, const unsigned char *, data));
+  } else if (s->suffix == '6') {
+    ipv6(str, ARG(args, const unsigned char *, data));
+  } else {
+    ipv4(str, ARG(args, unsigned int, integer));
+  }
+
+  s->pad = ' ';
+  s->precision = PRECISION_UNSET;
+  return strings(out, count, s, str);
+}
+
+/** Format pointer. */
+CONVERSION_INLINE size_t conv_pointer(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  const void *v;
+  WIDTH_AND_PRECISION_ARGS(s);
+  v = ARG(args, const void *, data);
+  s->flags |= FLAG_SQUARE;
+  if (v == NULL) {
+    return strings(out, count, s, "(nil)");
+  }
+  return hex(out, count, s, (LONGEST)v);
+}
+
+/** Store amount of characters put so far (what's the count ?). */
+CONVERSION_INLINE size_t conv_count(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+#ifndef SNPRINTF_NO_N
+  int *n = ARG(args, int *, pointer);
+  (void)out;
+  (void)s;
+  if (n != NULL) {
+    *n = (int)count;
+  }
+  return count;
+#else
+  (void)ARG(args, int *, pointer);
+  return placeholder(out, count, s);
+#endif
+}
+
+/** Put nothing just '%'. */
+CONVERSION_INLINE size_t conv_percent(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  (void)s;
+  (void)args;
+  (void)is_vector;
+  PUT_CHAR('%', out, count);
+  return count;
+}
+
+/**
+ * Format every element of @p array of @p type by @p format function with
+ * copy of @p s specification and put @p sep between elements.
+ */
+#define ARRAY_LOOP(type, format, array, n, s, sep, sep_len)             \
+  for (i = 0; i < (n) && count < out.size; i++) {                       \
+    struct SPEC e = *(s);                                               \
+    if (i > 0) {                                                        \
+      count = put_chars(out, count, sep, sep_len);                      \
+    }                                                                   \
+    count = format(out, count, &e, ((const type *)(array))[i]);         \
+  }
+
+/**
+ * Format array of numbers (or strings) given by pointer, amount of elements
+ * and separator (%V followed by conversion of element). The type of array
+ * is resolved only once, then all elements are formatted in one loop with
+ * the same flags, width and precision.
+ */
+CONVERSION_INLINE size_t conv_array(struct OUT out, size_t count,
+    struct SPEC *s, struct ARGS *args, int is_vector) {
+  size_t (*integer)(struct OUT, size_t, struct SPEC *, LONGEST) = decimal;
+  const void *array;
+  const char *sep;
+  size_t n, i, sep_len;
+  int is_signed = s->suffix == 'd' || s->suffix == 'i';
+
+  WIDTH_AND_PRECISION_ARGS(s);
+  array = ARG(args, const void *, data);
+  n = ARG(args, size_t, integer);
+  if (is_vector) {
+    sep = arg_string(args, PRECISION_UNSET, &sep_len);
+  } else {
+    sep = va_arg(*args->ap, const char *);
+    sep = sep != NULL ? sep : "";
+    sep_len = strlen(sep);
+  }
+
+  s->conv = s->suffix;
+  s->suffix = '\0';
+  s->flags &= ~(unsigned int)(FLAG_STAR_W | FLAG_STAR_P);
+
+  switch (s->conv) {
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+#ifndef SNPRINTF_NO_FLOAT
+      if (s->precision == PRECISION_UNSET) {
+        s->precision = 6;
+      }
+      ARRAY_LOOP(double, real, array, n, s, sep, sep_len);
+      return count;
+#endif
+    case 'a': case 'A':
+#ifndef SNPRINTF_NO_FLOAT
+      ARRAY_LOOP(double, hexfloat, array, n, s, sep, sep_len);
+      return count;
+#else
+      return placeholder(out, count, s);
+#endif
+
+    case 's':
+      ARRAY_LOOP(char *, strings, array, n, s, sep, sep_len);
+      return count;
+
+    case 'o':
+#ifndef SNPRINTF_NO_OCTAL
+      integer = octal;
+      break;
+#else
+      return placeholder(out, count, s);
+#endif
+    case 'x': case 'X':
+      integer = hex;
+      break;
+    case 'b': case 'B':
+      integer = binary;
+      break;
+    case 'd': case 'i': case 'u':
+      break;
+
+    default: /* unknown conversion of element */
+      return count;
+  }
+
+  switch (s->length) {
+    case INT_LEN_CHAR:
+      if (is_signed) {
+        ARRAY_LOOP(signed char, integer, array, n, s, sep, sep_len);
+      } else {
+        ARRAY_LOOP(unsigned char, integer, array, n, s, sep, sep_len);
+      }
+      break;
+    case INT_LEN_SHORT:
+      if (is_signed) {
+        ARRAY_LOOP(short, integer, array, n, s, sep, sep_len);
+      } else {
+        ARRAY_LOOP(unsigned short, integer, array, n, s, sep, sep_len);
+      }
+      break;
+    case INT_LEN_LONG:
+      if (is_signed) {
+        ARRAY_LOOP(long, integer, array, n, s, sep, sep_len);
+      } else {
+        ARRAY_LOOP(unsigned long, integer, array, n, s, sep, sep_len);
+      }
+      break;
+#ifndef SNPRINTF_NO_LONGLONG
+    case INT_LEN_LONG_LONG:
+      if (is_signed) {
+        ARRAY_LOOP(long long, integer, array, n, s, sep, sep_len);
+      } else {
+        ARRAY_LOOP(unsigned long long, integer, array, n, s, sep, sep_len);
+      }
+      break;
+#endif
+    case INT_LEN_DEFAULT:
+      if (is_signed) {
+        ARRAY_LOOP(int, integer, array, n, s, sep, sep_len);
+      } else {
+        ARRAY_LOOP(unsigned int, integer, array, n, s, sep, sep_len);
+      }
+      break;
+    default: /* unsupported length of element (w128) */
+      break;
+  }
+
+  return count;
+}
+
+/**
+ * Define instances of conversion @p name for variable arguments (name_va)
+ * and for array of tagged arguments (name_vector). Source of arguments is
+ * resolved once per call by choice of conversions table, not for each
+ * argument - va_list path has no test of it.
+ */
+#define CONVERSION(name)                                                \
+static size_t name##_va(struct OUT out, size_t count, struct SPEC *s,   \
+    struct ARGS *args) {                                                \
+  return name(out, count, s, args, 0);                                  \
+}                                                                       \
+static size_t name##_vector(struct OUT out, size_t count,               \
+    struct SPEC *s, struct ARGS *args) {                                \
+  return name(out, count, s, args, 1);                                  \
+}
+
+CONVERSION(conv_real)
+CONVERSION(conv_hexfloat)
+CONVERSION(conv_fixed)
+CONVERSION(conv_decimal)
+CONVERSION(conv_octal)
+CONVERSION(conv_hex)
+CONVERSION(conv_binary)
+CONVERSION(conv_char)
+CONVERSION(conv_string)
+CONVERSION(conv_slice)
+CONVERSION(conv_array)
+CONVERSION(conv_json)
+CONVERSION(conv_quoted)
+CONVERSION(conv_hexdump)
+CONVERSION(conv_timestamp)
+CONVERSION(conv_address)
+CONVERSION(conv_size)
+CONVERSION(conv_pointer)
+CONVERSION(conv_count)
+CONVERSION(conv_percent)
+
+/**
+ * Conversion functions of @p instance (_va or _vector) indexed by
+ * conversion character. NULL means unknown conversion character.
+ */
+#define CONVERSIONS(instance) {                                         \
+  ['f'] = conv_real##instance,      ['F'] = conv_real##instance,        \
+  ['e'] = conv_real##instance,      ['E'] = conv_real##instance,        \
+  ['g'] = conv_real##instance,      ['G'] = conv_real##instance,        \
+  ['a'] = conv_hexfloat##instance,  ['A'] = conv_hexfloat##instance,    \
+  ['k'] = conv_fixed##instance,     ['K'] = conv_fixed##instance,       \
+  ['r'] = conv_fixed##instance,     ['R'] = conv_fixed##instance,       \
+  ['d'] = conv_decimal##instance,   ['i'] = conv_decimal##instance,     \
+  ['u'] = conv_decimal##instance,   ['o'] = conv_octal##instance,       \
+  ['x'] = conv_hex##instance,       ['X'] = conv_hex##instance,         \
+  ['b'] = conv_binary##instance,    ['B'] = conv_binary##instance,      \
+  ['c'] = conv_char##instance,      ['s'] = conv_string##instance,      \
+  ['S'] = conv_slice##instance,     ['V'] = conv_array##instance,       \
+  ['J'] = conv_json##instance,      ['Q'] = conv_quoted##instance,      \
+  ['H'] = conv_hexdump##instance,   ['T'] = conv_timestamp##instance,   \
+  ['I'] = conv_address##instance,   ['M'] = conv_address##instance,     \
+  ['Z'] = conv_size##instance,      ['p'] = conv_pointer##instance,     \
+  ['n'] = conv_count##instance,     ['%'] = conv_percent##instance      \
+}
+
+/** Conversion functions for variable arguments. */
+static size_t (*const conversions[256])(struct OUT, size_t, struct SPEC *,
+    struct ARGS *) = CONVERSIONS(_va);
+
+/** Conversion functions for array of tagged arguments. */
+static size_t (*const conversions_vector[256])(struct OUT, size_t,
+    struct SPEC *, struct ARGS *) = CONVERSIONS(_vector);
+
+/** Class of format character - conversion (or unknown) character. */
+#define CLASS_OTHER           0
+/** Class of format character - '-' flag. */
+#define CLASS_MINUS           1
+/** Class of format character - '+' flag. */
+#define CLASS_PLUS            2
+/** Class of format character - ' ' flag. */
+#define CLASS_SPACE           3
+/** Class of format character - '#' flag. */
+#define CLASS_SQUARE          4
+/** Class of format character - '0' flag. */
+#define CLASS_ZERO            5
+/** Class of format character - '1' ... '9' digit. */
+#define CLASS_DIGIT           6
+/** Class of format character - '.' before precision. */
+#define CLASS_DOT             7
+/** Class of format character - '*' width or precision given as argument. */
+#define CLASS_STAR            8
+/** Class of format character - 'h' or 'l' length. */
+#define CLASS_LENGTH          9
+/** Class of format character - '\'' flag. */
+#define CLASS_QUOTE          10
+
+/** Classes of format characters (CLASS_OTHER if not listed). */
+static const unsigned char format_class[256] = {
+  ['-'] = CLASS_MINUS,    ['+'] = CLASS_PLUS,     [' '] = CLASS_SPACE,
+  ['#'] = CLASS_SQUARE,   ['0'] = CLASS_ZERO,     ['\''] = CLASS_QUOTE,
+  ['1'] = CLASS_DIGIT,    ['2'] = CLASS_DIGIT,    ['3'] = CLASS_DIGIT,
+  ['4'] = CLASS_DIGIT,    ['5'] = CLASS_DIGIT,    ['6'] = CLASS_DIGIT,
+  ['7'] = CLASS_DIGIT,    ['8'] = CLASS_DIGIT,    ['9'] = CLASS_DIGIT,
+  ['.'] = CLASS_DOT,      ['*'] = CLASS_STAR,
+  ['h'] = CLASS_LENGTH,   ['l'] = CLASS_LENGTH
+};
+
+/** Class of @p c format character. */
+#define FORMAT_CLASS(c)       format_class[(unsigned char)(c)]
+
+/**
+ * Convert decimal digits of @p a string to @p res integer.
+ *
+ * @return Pointer to the first not digit character of @p a.
+ */
+static const char *parse_int(const char *a, int *res) {
+  unsigned int digit;
+
+  for (*res = 0; (digit = (unsigned int)(*a - '0')) < 10; a++) {
+    *res = *res * 10 + (int)digit;
+  }
+
+  return a;
+}
+
+/**
+ * Parse conversion specification in one pass:
+ * [flags][width][.precision][length]conversion.
+ *
+ * @param s Specification of field to fill.
+ * @param f Format string just after '%' character.
+ *
+ * @return Pointer to conversion character (could be '\0').
+ */
+static const char *parse_spec(struct SPEC *s, const char *f) {
+  unsigned int flags = 0;
+
+  for (;; f++) { /* flags in any order */
+    switch (FORMAT_CLASS(*f)) {
+      case CLASS_MINUS:
+        flags |= FLAG_LEFT;
+        continue;
+
+      case CLASS_PLUS:
+        flags |= FLAG_PLUS;
+        continue;
+
+      case CLASS_SPACE:
+        flags |= FLAG_SPACE;
+        continue;
+
+      case CLASS_SQUARE:
+        flags |= FLAG_SQUARE;
+        continue;
+
+      case CLASS_ZERO:
+        flags |= FLAG_ZERO;
+        continue;
+
+      case CLASS_QUOTE:
+        flags |= FLAG_QUOTE;
+        continue;
+
+      default:
+        break;
+    }
+    break;
+  }
+
+  s->width = WIDTH_UNSET;
+  if (FORMAT_CLASS(*f) == CLASS_STAR) {
+    flags |= FLAG_STAR_W;
+    f++;
+  } else if (FORMAT_CLASS(*f) == CLASS_DIGIT) {
+    f = parse_int(f, &s->width);
+  }
+
+  /* a dot without digits leaves precision undefined */
+  s->precision = PRECISION_UNSET;
+  if (FORMAT_CLASS(*f) == CLASS_DOT) {
+    f++;
+    if (FORMAT_CLASS(*f) == CLASS_STAR) {
+      flags |= FLAG_STAR_P;
+      f++;
+    } else if ((unsigned int)(*f - '0') < 10) {
+      f = parse_int(f, &s->precision);
+    }
+  }
+
+  s->length = INT_LEN_DEFAULT;
+  for (; FORMAT_CLASS(*f) == CLASS_LENGTH; f++) {
+    if (*f == 'l') { /* long or long long */
+      s->length = s->length == INT_LEN_LONG ? INT_LEN_LONG_LONG : INT_LEN_LONG;
+    } else { /* short or char */
+      s->length = s->length == INT_LEN_SHORT ? INT_LEN_CHAR : INT_LEN_SHORT;
+    }
+  }
+#ifdef SNPRINTF_INT128
+  if (f[0] == 'w' && f[1] == '1' && f[2] == '2' && f[3] == '8') {
+    s->length = INT_LEN_INT128;
+    f += 4;
+  }
+#endif
+
+  s->flags = flags;
+  s->pad = (flags & (FLAG_ZERO | FLAG_LEFT)) == FLAG_ZERO ? '0' : ' ';
+  s->conv = *f;
+  s->suffix = '\0';
+  if (*f == 'I' && (f[1] == '4' || f[1] == '6')) { /* IP address version */
+    s->suffix = *++f;
+  } else if (*f == 'V' && f[1] != '\0') { /* conversion of array element */
+    s->suffix = *++f;
+  }
+
+  return f;
+}
+
+/**
+ * Initialize @p out for @p string output buffer of @p length size.
+ *
+ * @return 1 if there is room at least for '\0' character, 0 otherwise.
+ */
+static int out_init(struct OUT *out, char *string, size_t length) {
   /* calculate only size of output string */
   if (string == NULL) {
     length = __SIZE_MAX__;
   /* sanity check, the string must be > 1 */
   } else if (length < 1) {
+    return 0;
+  }
+
+  out->ps = string;
+  out->size = length - 1; /* leave room for '\0' */
+  return 1;
+}
+
+/** Put '\0' after @p count characters of @p out and return @p count. */
+static int out_finish(struct OUT out, size_t count) {
+  if (out.ps != NULL) {
+    out.ps[count] = '\0'; /* the end ye ! */
+  }
+
+  return (int)count;
+}
+
+/**
+ * Format @p format string with input arguments taken from @p args to
+ * @p out and return amount of characters put.
+ */
+static size_t formats(struct OUT out, const char *format, struct ARGS *args) {
+  size_t (*const *table)(struct OUT, size_t, struct SPEC *, struct ARGS *) =
+    args->ap != NULL ? conversions : conversions_vector;
+  size_t count = 0;
+  const char *pf = format;
+
+  for (; *pf != '\0' && count < out.size; pf++) {
+    if (*pf == '%') { /* we got a magic % cookie */
+      struct SPEC spec;
+      size_t (*conversion)(struct OUT, size_t, struct SPEC *, struct ARGS *);
+
+      pf = parse_spec(&spec, pf + 1);
+      conversion = table[(unsigned char)spec.conv];
+      if (conversion != NULL) {
+        count = conversion(out, count, &spec, args);
+      } else { /* is this an error ? maybe bail out */
+        PUT_CHAR('%', out, count);
+        if (*pf == '\0') { /* a NULL here ? ? bail out */
+          break;
+        }
+      }
+    } else { /* not % */
+      PUT_CHAR(*pf, out, count); /* add the char the string */
+    }
+  }
+
+  return count;
+}
+
+SNPRINTF_API int (vsnprintf)(char *string, size_t length, const char *format, va_list args) {
+  struct OUT out;
+  struct ARGS in = { NULL, NULL, 0, 0 };
+  size_t count;
+  va_list ap;
+
+  if (!out_init(&out, string, length)) {
+    return -1;
+  }
+
+  va_copy(ap, args);
+  in.ap = &ap;
+  count = formats(out, format, &in);
+  va_end(ap);
+
+  return out_finish(out, count);
+}
+
+SNPRINTF_API int (snprintf)(char *string, size_t length, const char *format, ...) {
+  int rval;
+  va_list args;
+
+  va_start(args, format);
+  rval = vsnprintf(string, length, format, args);
+  va_end(args);
+
+  return rval;
+}
+
+SNPRINTF_API int snprintf_args(char *string, size_t length,
+    const char *format, const struct snprintf_arg *args, size_t count) {
+  struct OUT out;
+  struct ARGS in = { NULL, args, count, 0 };
+
+  if (!out_init(&out, string, length)) {
+    return -1;
+  }
+
+  return out_finish(out, formats(out, format, &in));
+}
+
+/**
+ * Put types of input arguments taken by conversion of @p s specification
+ * (in order of arguments) to @p types and return their amount.
+ */
+static int spec_signature(const struct SPEC *s, int types[5]) {
+  int n = 0;
+
+  switch (s->conv) {
+    case 'n': case '%':
+      break; /* width and precision are never taken as arguments */
+    default:
+      if (s->flags & FLAG_STAR_W) {
+        types[n++] = SNPRINTF_ARG_INT;
+      }
+      if (s->flags & FLAG_STAR_P) {
+        types[n++] = SNPRINTF_ARG_INT;
+      }
+      break;
+  }
+
+  switch (s->conv) {
+    case 'k': case 'r':
+      types[n++] = SNPRINTF_ARG_INT; /* scale */
+      types[n++] = SNPRINTF_ARG_INT;
+      break;
+    case 'K': case 'R':
+      types[n++] = SNPRINTF_ARG_INT; /* scale */
+      types[n++] = SNPRINTF_ARG_UINT;
+      break;
+    case 'd': case 'i': case 'c': case 'T':
+      types[n++] = SNPRINTF_ARG_INT;
+      break;
+    case 'u': case 'o': case 'x': case 'X': case 'b': case 'B': case 'Z':
+      types[n++] = SNPRINTF_ARG_UINT;
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+    case 'a': case 'A':
+      types[n++] = SNPRINTF_ARG_DOUBLE;
+      break;
+    case 's': case 'S': case 'J': case 'Q': case 'H':
+      types[n++] = SNPRINTF_ARG_STRING;
+      break;
+    case 'I':
+      types[n++] = s->suffix == '6' ? SNPRINTF_ARG_POINTER : SNPRINTF_ARG_UINT;
+      break;
+    case 'M': case 'p': case 'n':
+      types[n++] = SNPRINTF_ARG_POINTER;
+      break;
+    case 'V':
+      types[n++] = SNPRINTF_ARG_POINTER;
+      types[n++] = SNPRINTF_ARG_UINT; /* amount of elements */
+      types[n++] = SNPRINTF_ARG_STRING; /* separator */
+      break;
+    default: /* '%' or unknown conversion */
+      break;
+  }
+
+  return n;
+}
+
+SNPRINTF_API int snprintf_signature(const char *format, int *types,
+    size_t size) {
+  const char *pf = format;
+  size_t n = 0;
+
+  for (; *pf != '\0'; pf++) {
+    struct SPEC spec;
+    int spec_types[5], i, spec_n;
+
+    if (*pf != '%') {
+      continue;
+    }
+
+    pf = parse_spec(&spec, pf + 1);
+    if (conversions[(unsigned char)spec.conv] == NULL && *pf == '\0') {
+      break;
+    }
+
+    spec_n = spec_signature(&spec, spec_types);
+    for (i = 0; i < spec_n; i++, n++) {
+      if (types != NULL && n < size) {
+        types[n] = spec_types[i];
+      }
+    }
+  }
+
+  return (int)n;
+}
+
+#ifdef SNPRINTF_CACHE
+#ifndef SNPRINTF_CACHE_ENTRIES
+/** Amount of results kept in cache of every thread (multiple of CACHE_WAYS). */
+#define SNPRINTF_CACHE_ENTRIES  32
+#endif
+
+#ifndef SNPRINTF_CACHE_SIZE
+/** Maximum size of key (format and arguments) and of result in cache. */
+#define SNPRINTF_CACHE_SIZE     128
+#endif
+
+/** Amount of entries of cache where result of the same key could be. */
+#define CACHE_WAYS            4
+
+/** Result of snprintf_cached() kept in cache together with its key. */
+struct CACHE_ENTRY {
+  unsigned long long hash;    /**< hash of CACHE_ENTRY::key */
+  unsigned long used;         /**< time of the last use (0 for free entry) */
+  size_t key_len;             /**< length of CACHE_ENTRY::key */
+  size_t len;                 /**< length of CACHE_ENTRY::value */
+  char key[SNPRINTF_CACHE_SIZE];    /**< format pointer and arguments */
+  char value[SNPRINTF_CACHE_SIZE];  /**< formatted result */
+};
+
+#ifdef THREAD_LOCAL
+/** Cache of results of snprintf_cached() of thread (LRU in every set). */
+static THREAD_LOCAL struct {
+  struct CACHE_ENTRY entries[SNPRINTF_CACHE_ENTRIES];
+  unsigned long clock;        /**< time of the last use of any entry */
+  struct snprintf_cache_stats stats;
+} cache;
+#endif
+
+/**
+ * Append @p len bytes of @p data to @p key of @p key_len length.
+ *
+ * @return 0 on success, -1 if there is no room in @p key.
+ */
+static int cache_key_append(char *key, size_t *key_len, const void *data,
+    size_t len) {
+  if (len > SNPRINTF_CACHE_SIZE - *key_len) {
+    return -1;
+  }
+
+  memcpy(key + *key_len, data, len);
+  *key_len += len;
+  return 0;
+}
+
+/**
+ * Append tagged argument @p a taken by @p s conversion to @p key of
+ * @p key_len length: value of number, contents of string.
+ *
+ * @return 0 on success, -1 if result must not be cached (pointer to data
+ *         other than string or there is no room in @p key).
+ */
+static int cache_key_arg(char *key, size_t *key_len, const struct SPEC *s,
+    const struct snprintf_arg *a) {
+  char type = (char)a->type;
+  const char *str;
+  size_t len;
+
+  if (cache_key_append(key, key_len, &type, 1) != 0) {
+    return -1;
+  }
+
+  switch (a->type) {
+    case SNPRINTF_ARG_STRING:
+      str = a->value.s.str;
+      len = str != NULL ? a->value.s.len : 0;
+      break;
+    case SNPRINTF_ARG_POINTER:
+      if (s->conv == 'p') {
+        return cache_key_append(key, key_len, &a->value.p, sizeof(a->value.p));
+      } else if ((s->conv != 's' && s->conv != 'J' && s->conv != 'Q') ||
+          (s->flags & FLAG_STAR_P)) { /* data could change behind pointer */
+        return -1;
+      }
+      str = (const char *)a->value.p;
+      len = str != NULL ? string_length(str, s->precision) : 0;
+      break;
+    case SNPRINTF_ARG_DOUBLE:
+      return cache_key_append(key, key_len, &a->value.d, sizeof(a->value.d));
+    default:
+      return cache_key_append(key, key_len, &a->value.u, sizeof(a->value.u));
+  }
+
+  if (cache_key_append(key, key_len, &len, sizeof(len)) != 0) {
+    return -1;
+  }
+  return cache_key_append(key, key_len, str, len);
+}
+
+/**
+ * Build @p key of snprintf_cached() call from @p format pointer and from
+ * @p args arguments taken by its conversions.
+ *
+ * @return Length of @p key or 0 if result must not be cached.
+ */
+static size_t cache_key(char *key, const char *format,
+    const struct snprintf_arg *args, size_t count) {
+  const char *pf;
+  size_t key_len = 0, next = 0;
+
+  (void)cache_key_append(key, &key_len, &format, sizeof(format));
+
+  for (pf = strchr(format, '%'); pf != NULL; pf = strchr(pf + 1, '%')) {
+    struct SPEC spec;
+    int types[5], i, n;
+
+    pf = parse_spec(&spec, pf + 1);
+    if (*pf == '\0') { /* '%' at the end takes nothing */
+      break;
+    }
+
+    n = spec_signature(&spec, types);
+    for (i = 0; i < n && next < count; i++, next++) {
+      if (spec.conv == 'n' ||
+          cache_key_arg(key, &key_len, &spec, &args[next]) != 0) {
+        return 0;
+      }
+    }
+  }
+
+  return key_len;
+}
+
+/** Get hash of @p len bytes of @p key mixed by 8 bytes at once. */
+static unsigned long long cache_hash(const char *key, size_t len) {
+  unsigned long long hash = 14695981039346656037ULL ^ len, word;
+  size_t i;
+
+  for (i = 0; i + sizeof(word) <= len; i += sizeof(word)) {
+    memcpy(&word, key + i, sizeof(word));
+    hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+  }
+  word = 0;
+  memcpy(&word, key + i, len - i);
+  hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+
+  return hash ^ (hash >> 32); /* high bits to index of set */
+}
+
+SNPRINTF_API int snprintf_cached(char *string, size_t length,
+    const char *format, const struct snprintf_arg *args, size_t count) {
+#ifdef THREAD_LOCAL
+  char key[SNPRINTF_CACHE_SIZE];
+  struct CACHE_ENTRY *set, *victim;
+  unsigned long long hash;
+  size_t key_len, i;
+  int rval;
+
+  key_len = string != NULL ? cache_key(key, format, args, count) : 0;
+  if (key_len == 0) {
+    cache.stats.bypasses++;
+    return snprintf_args(string, length, format, args, count);
+  }
+
+  hash = cache_hash(key, key_len);
+  set = &cache.entries[hash % (SNPRINTF_CACHE_ENTRIES / CACHE_WAYS) * CACHE_WAYS];
+  victim = set;
+  for (i = 0; i < CACHE_WAYS; i++) {
+    struct CACHE_ENTRY *e = &set[i];
+
+    if (e->used != 0 && e->hash == hash && e->key_len == key_len &&
+        memcmp(e->key, key, key_len) == 0) {
+      struct OUT out;
+
+      e->used = ++cache.clock;
+      cache.stats.hits++;
+      if (!out_init(&out, string, length)) {
+        return -1;
+      }
+      return out_finish(out, put_chars(out, 0, e->value, e->len));
+    }
+    if (e->used < victim->used) { /* the least recently used one */
+      victim = e;
+    }
+  }
+
+  cache.stats.misses++;
+  rval = snprintf_args(string, length, format, args, count);
+
+  /* keep result only if it is not truncated */
+  if (rval >= 0 && (size_t)rval < length - 1 &&
+      (size_t)rval <= SNPRINTF_CACHE_SIZE) {
+    if (victim->used != 0) {
+      cache.stats.evictions++;
+    }
+    victim->hash = hash;
+    victim->used = ++cache.clock;
+    victim->key_len = key_len;
+    victim->len = (size_t)rval;
+    memcpy(victim->key, key, key_len);
+    memcpy(victim->value, string, (size_t)rval);
+  }
+
+  return rval;
+#else
+  return snprintf_args(string, length, format, args, count);
+#endif
+}
+
+SNPRINTF_API void snprintf_cache_stats(struct snprintf_cache_stats *stats) {
+#ifdef THREAD_LOCAL
+  *stats = cache.stats;
+#else
+  memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+SNPRINTF_API void snprintf_cache_clear(void) {
+#ifdef THREAD_LOCAL
+  memset(&cache, 0, sizeof(cache));
+#endif
+}
+#endif
+
+/**
+ * Format one integer argument according to @p s specification - fast path
+ * for literal formats (@see SNPRINTF_FAST_PATH) which skips parsing.
+ */
+static int fast_integer(char *string, size_t length, struct SPEC *s,
+    va_list *args) {
+  struct OUT out;
+  struct ARGS in = { NULL, NULL, 0, 0 };
+
+  if (!out_init(&out, string, length)) {
+    return -1;
+  }
+
+  in.ap = args;
+  return out_finish(out, s->conv == 'x' ?
+    conv_hex_va(out, 0, s, &in) : conv_decimal_va(out, 0, s, &in));
+}
+
+/**
+ * Define fast path function @p name for literal format with one integer
+ * conversion described by SPEC fields: @p width, @p flags, @p int_len,
+ * @p conv and @p pad.
+ */
+#define FAST_INTEGER(name, width, flags, int_len, conv, pad)            \
+SNPRINTF_API int name(char *string, size_t length,                      \
+    const char *format, ...) {                                          \
+  struct SPEC spec = {                                                  \
+    width, PRECISION_UNSET, flags, int_len, conv, pad, '\0'             \
+  };                                                                    \
+  int rval;                                                             \
+  va_list args;                                                         \
+                                                                        \
+  va_start(args, format);                                               \
+  rval = fast_integer(string, length, &spec, &args);                    \
+  va_end(args);                                                         \
+                                                                        \
+  return rval;                                                          \
+}
+
+FAST_INTEGER(snprintf_fast_d, WIDTH_UNSET, 0, INT_LEN_DEFAULT, 'd', ' ')
+FAST_INTEGER(snprintf_fast_u, WIDTH_UNSET, 0, INT_LEN_DEFAULT, 'u', ' ')
+FAST_INTEGER(snprintf_fast_ld, WIDTH_UNSET, 0, INT_LEN_LONG, 'd', ' ')
+FAST_INTEGER(snprintf_fast_lu, WIDTH_UNSET, 0, INT_LEN_LONG, 'u', ' ')
+FAST_INTEGER(snprintf_fast_lld, WIDTH_UNSET, 0, INT_LEN_LONG_LONG, 'd', ' ')
+FAST_INTEGER(snprintf_fast_llu, WIDTH_UNSET, 0, INT_LEN_LONG_LONG, 'u', ' ')
+FAST_INTEGER(snprintf_fast_x, WIDTH_UNSET, 0, INT_LEN_DEFAULT, 'x', ' ')
+FAST_INTEGER(snprintf_fast_08x, 8, FLAG_ZERO, INT_LEN_DEFAULT, 'x', '0')
+
+SNPRINTF_API int snprintf_fast_s(char *string, size_t length,
+    const char *format, ...) {
+  struct SPEC spec = { WIDTH_UNSET, PRECISION_UNSET, 0, INT_LEN_DEFAULT, 's', ' ', '\0' };
+  struct OUT out;
+  size_t count;
+  va_list args;
+
+  if (!out_init(&out, string, length)) {
+    return -1;
+  }
+
+  va_start(args, format);
+  count = strings(out, 0, &spec, va_arg(args, char *));
+  va_end(args);
+
+  return out_finish(out, count);
+}
+
+SNPRINTF_API int snprintf_fast_s_eq_d(char *string, size_t length,
+    const char *format, ...) {
+  struct SPEC spec = { WIDTH_UNSET, PRECISION_UNSET, 0, INT_LEN_DEFAULT, 's', ' ', '\0' };
+  struct OUT out;
+  size_t count;
+  va_list args;
+
+  if (!out_init(&out, string, length)) {
+    return -1;
+  }
+
+  va_start(args, format);
+  count = strings(out, 0, &spec, va_arg(args, char *));
+  PUT_CHAR('=', out, count);
+  spec.width = WIDTH_UNSET;
+  spec.conv = 'd';
+  count = decimal(out, count, &spec, va_arg(args, int));
+  va_end(args);
+
+  return out_finish(out, count);
+}
+
+SNPRINTF_API void sb_init(struct sb *sb, char *base, size_t capacity) {
+  sb->base = base;
+  sb->capacity = capacity;
+  sb->position = 0;
+  /* no room even for '\0' character */
+  sb->overflow = base != NULL && capacity < 1;
+}
+
+/** Mark @p sb as overflowed and account @p n characters which do not fit. */
+static int sb_skip(struct sb *sb, size_t n) {
+  if (sb->base != NULL && n > 0) {
+    sb->overflow = 1;
+  }
+  sb->position += n;
+  return (int)n;
+}
+
+SNPRINTF_API int sb_vprintf(struct sb *sb, const char *format, va_list args) {
+  int n = 0;
+
+  if (!sb->overflow && sb->base != NULL) {
+    size_t room = sb->capacity - sb->position; /* with '\0' character */
+    va_list copy;
+
+    va_copy(copy, args);
+    n = vsnprintf(sb->base + sb->position, room, format, copy);
+    va_end(copy);
+
+    if ((size_t)n + 1 < room) { /* everything fit for sure */
+      sb->position += (size_t)n;
+      return n;
+    }
+    sb->position += (size_t)n;
+  }
+
+  /* output is truncated (or buffer is exactly full) - count the rest */
+  return n + sb_skip(sb, (size_t)vsnprintf(NULL, 0, format, args) - (size_t)n);
+}
+
+SNPRINTF_API int sb_printf(struct sb *sb, const char *format, ...) {
+  int rval;
+  va_list args;
+
+  va_start(args, format);
+  rval = sb_vprintf(sb, format, args);
+  va_end(args);
+
+  return rval;
+}
+
+SNPRINTF_API int sb_putc(struct sb *sb, char c) {
+  if (!sb->overflow && sb->base != NULL && sb->position + 1 < sb->capacity) {
+    sb->base[sb->position++] = c;
+    return 1;
+  }
+
+  return sb_skip(sb, 1);
+}
+
+SNPRINTF_API int sb_puts(struct sb *sb, const char *s) {
+  const char *ps = s;
+
+  if (!sb->overflow && sb->base != NULL) {
+    char *pd = sb->base + sb->position;
+    char *pe = sb->base + sb->capacity - 1; /* leave room for '\0' */
+
+    for (; *ps != '\0' && pd < pe; ps++) {
+      *pd++ = *ps;
+    }
+    sb->position = (size_t)(pd - sb->base);
+  }
+
+  return (int)(ps - s) + sb_skip(sb, strlen(ps));
+}
+
+SNPRINTF_API int sb_pad(struct sb *sb, char c, size_t count) {
+  size_t n = 0;
+
+  if (!sb->overflow && sb->base != NULL) {
+    n = sb->capacity - 1 - sb->position;
+    n = count < n ? count : n;
+    memset(sb->base + sb->position, c, n);
+    sb->position += n;
+  }
+
+  return (int)n + sb_skip(sb, count - n);
+}
+
+SNPRINTF_API int sb_finish(struct sb *sb) {
+  if (sb->base != NULL) {
+    if (sb->capacity < 1) {
+      return -1;
+    }
+    sb->base[sb->overflow ? sb->capacity - 1 : sb->position] = '\0';
+  }
+
+  return (int)sb->position;
+}
+
+SNPRINTF_API int logfmt_compile(char *tmpl, size_t size,
+    const struct logfmt_field *fields, size_t count) {
+  struct sb sb;
+  size_t i;
+
+  sb_init(&sb, tmpl, size);
+  for (i = 0; i < count; i++) {
+    const char *key = fields[i].key, *format = fields[i].format, *pf;
+    struct SPEC spec;
+    size_t conv;
+
+    /* key must be one word without '=', '"' and '%' */
+    if (key == NULL || key[0] == '\0' || strchr(key, '%') != NULL ||
+        logfmt_clean(key, strlen(key)) != strlen(key)) {
+      return -1;
+    }
+
+    /* format must be exactly one conversion which takes argument */
+    if (format == NULL || format[0] != '%') {
+      return -1;
+    }
+    pf = parse_spec(&spec, format + 1);
+    if (conversions[(unsigned char)spec.conv] == NULL || spec.conv == '%' ||
+        spec.conv == 'n' || pf[1] != '\0') {
+      return -1;
+    }
+
+    /* string value is quoted when it is needed (%s -> %Q) */
+    conv = (size_t)(pf - format) - (spec.suffix != '\0');
+    sb_printf(&sb, "%s%s=%.*s%s", i > 0 ? " " : "", key, (int)conv, format,
+      spec.conv == 's' ? "Q" : format + conv);
+  }
+
+  return sb.overflow ? -1 : sb_finish(&sb);
+}
+
+#ifdef SNPRINTF_IOV
+/** Output of vsnprintf_iov() - array of iovec entries and scratch area. */
+struct IOV {
+  struct iovec *iov;          /**< output array of iovec entries */
+  int iovcnt;                 /**< size of IOV::iov */
+  int n;                      /**< amount of entries used in IOV::iov */
+  char *scratch;              /**< buffer for converted numbers and padding */
+  size_t size;                /**< size of IOV::scratch */
+  size_t used;                /**< amount of characters used in IOV::scratch */
+  size_t total;               /**< length of whole output */
+};
+
+/**
+ * Append @p len characters at @p base to @p v output. Characters which are
+ * just after the last iovec entry extend it instead of using the next one.
+ *
+ * @return 0 on success, -1 if there is no free iovec entry.
+ */
+static int iov_append(struct IOV *v, const char *base, size_t len) {
+  if (len == 0) {
+    return 0;
+  }
+
+  v->total += len;
+  if (v->n > 0 &&
+      (const char *)v->iov[v->n - 1].iov_base + v->iov[v->n - 1].iov_len == base) {
+    v->iov[v->n - 1].iov_len += len;
+    return 0;
+  }
+
+  if (v->n >= v->iovcnt) {
+    return -1;
+  }
+
+  v->iov[v->n].iov_base = (void *)base; /* writev() does not modify it */
+  v->iov[v->n].iov_len = len;
+  v->n++;
+  return 0;
+}
+
+/**
+ * Put @p count times @p c padding character to scratch area of @p v.
+ *
+ * @return 0 on success, -1 if scratch area or iovec array is too small.
+ */
+static int iov_pad(struct IOV *v, char c, size_t count) {
+  if (count == 0) {
+    return 0;
+  } else if (count >= v->size - v->used) {
+    return -1;
+  }
+
+  memset(v->scratch + v->used, c, count);
+  v->used += count;
+  return iov_append(v, v->scratch + v->used - count, count);
+}
+
+/**
+ * Reference string argument (%s, %S) in place with padding in scratch area.
+ *
+ * @return 0 on success, -1 if scratch area or iovec array is too small.
+ */
+static int iov_string(struct IOV *v, struct SPEC *s, struct ARGS *args) {
+  const int is_vector = 0; /* only variable arguments */
+  const char *str;
+  size_t len, pad = 0;
+
+  WIDTH_AND_PRECISION_ARGS(s);
+  if (s->conv == 'S') {
+    SIZED_ARG(const char *, str, len);
+  } else {
+    STRING_ARG(s, str, len);
+  }
+  if (s->precision != PRECISION_UNSET && len > (size_t)s->precision) {
+    len = (size_t)s->precision;
+  }
+  if (s->width > 0 && (size_t)s->width > len) {
+    pad = (size_t)s->width - len;
+  }
+
+  if (!(s->flags & FLAG_LEFT) && iov_pad(v, s->pad, pad) != 0) {
+    return -1;
+  }
+  if (iov_append(v, str, len) != 0) {
+    return -1;
+  }
+  if ((s->flags & FLAG_LEFT) && iov_pad(v, s->pad, pad) != 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+SNPRINTF_API int vsnprintf_iov(struct iovec *iov, int iovcnt,
+    char *scratch, size_t size, const char *format, va_list args) {
+  struct IOV v;
+  const char *pf = format, *literal = format, *percent;
+  int rval = 0;
+  struct ARGS in = { NULL, NULL, 0, 0 };
+  va_list ap;
+
+  v.iov = iov;
+  v.iovcnt = iovcnt;
+  v.n = 0;
+  v.scratch = scratch;
+  v.size = scratch != NULL ? size : 0;
+  v.used = 0;
+  v.total = 0;
+
+  va_copy(ap, args);
+  in.ap = &ap;
+
+  for (; *pf != '\0' && rval == 0; pf++) {
+    struct SPEC spec;
+    size_t (*conversion)(struct OUT, size_t, struct SPEC *, struct ARGS *);
+
+    if (*pf != '%') {
+      continue;
+    }
+
+    rval = iov_append(&v, literal, (size_t)(pf - literal));
+    percent = pf;
+    pf = parse_spec(&spec, pf + 1);
+    literal = pf + 1;
+    conversion = conversions[(unsigned char)spec.conv];
+
+    if (rval != 0) {
+      break;
+    } else if (conversion == NULL || spec.conv == '%') { /* '%' in place */
+      rval = iov_append(&v, percent, 1);
+      if (*pf == '\0') { /* a NULL here ? ? bail out */
+        literal = pf;
+        break;
+      }
+    } else if (spec.conv == 's' || spec.conv == 'S') {
+      rval = iov_string(&v, &spec, &in);
+#ifndef SNPRINTF_NO_N
+    } else if (spec.conv == 'n') {
+      int *n = va_arg(ap, int *);
+      if (n != NULL) {
+        *n = (int)v.total;
+      }
+#endif
+    } else { /* converted into scratch area */
+      struct OUT out;
+      size_t count;
+
+      out.ps = v.scratch + v.used;
+      out.size = v.size - v.used;
+      count = conversion(out, 0, &spec, &in);
+      if (count >= out.size) { /* could be truncated */
+        rval = -1;
+      } else {
+        v.used += count;
+        rval = iov_append(&v, out.ps, count);
+      }
+    }
+  }
+
+  if (rval == 0) {
+    rval = iov_append(&v, literal, strlen(literal));
+  }
+
+  va_end(ap);
+
+  return rval == 0 ? v.n : -1;
+}
+
+SNPRINTF_API int snprintf_iov(struct iovec *iov, int iovcnt,
+    char *scratch, size_t size, const char *format, ...) {
+  int rval;
+  va_list args;
+
+  va_start(args, format);
+  rval = vsnprintf_iov(iov, iovcnt, scratch, size, format, args);
+  va_end(args);
+
+  return rval;
+}
+#endif
+
+#ifdef SNPRINTF_MMAP
+/** Grow @p ms file and its mapping to at least @p size bytes. */
+static int mmap_sink_grow(struct mmap_sink *ms, size_t size) {
+  size_t mapped = (size + ms->extent - 1) / ms->extent * ms->extent;
+  void *base;
+
+  if (ftruncate(ms->fd, (off_t)mapped) != 0) {
+    return -1;
+  }
+
+  base = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, ms->fd, 0);
+  if (base == MAP_FAILED) {
+    return -1;
+  }
+
+  if (ms->base != NULL) {
+    munmap(ms->base, ms->mapped);
+  }
+  ms->base = (char *)base;
+  ms->mapped = mapped;
+  return 0;
+}
+
+SNPRINTF_API int mmap_sink_open(struct mmap_sink *ms, const char *path,
+    size_t extent) {
+  ms->base = NULL;
+  ms->mapped = 0;
+  ms->position = 0;
+  ms->extent = extent > 0 ? extent : MMAP_SINK_EXTENT;
+
+  ms->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (ms->fd < 0) {
+    return -1;
+  }
+
+  if (mmap_sink_grow(ms, ms->extent) != 0) {
+    close(ms->fd);
+    ms->fd = -1;
     return -1;
   }
 
-  data.ps_size = length - 1; /* leave room for '\0' */
-  data.ps = string;
-  data.pf = format;
-  data.counter = 0;
-
-  for (; *data.pf != '\0' && (data.counter < data.ps_size); data.pf++) {
-    if (*data.pf == '%') { /* we got a magic % cookie */
-      int is_continue = 1;
-      conv_flags(&data); /* initialise format flags */
-      while (*data.pf != '\0' && is_continue) {
-        switch (*(++data.pf)) {
-          case '\0': /* a NULL here ? ? bail out */
-            PUT_CHAR('%', &data);
-            if (data.ps != NULL) {
-              *data.ps = '\0';
-            }
-            return (int)data.counter;
-
-          case 'f':
-          case 'F': { /* decimal floating point */
-            double d;
-            DOUBLE_ARG(&data, d);
-            floating(&data, d);
-            is_continue = 0;
-            break;
-          }
+  return 0;
+}
+
+SNPRINTF_API int mmap_sink_vprintf(struct mmap_sink *ms, const char *format,
+    va_list args) {
+  size_t room = ms->mapped - ms->position; /* with '\0' character */
+  va_list copy;
+  int n;
+
+  va_copy(copy, args);
+  n = vsnprintf(ms->base + ms->position, room, format, copy);
+  va_end(copy);
+
+  if (n >= 0 && (size_t)n + 1 >= room) { /* could be truncated */
+    va_copy(copy, args);
+    n = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+
+    if (mmap_sink_grow(ms, ms->position + (size_t)n + 1) != 0) {
+      return -1;
+    }
+    n = vsnprintf(ms->base + ms->position, ms->mapped - ms->position,
+      format, args);
+  }
+
+  if (n > 0) {
+    ms->position += (size_t)n;
+  }
+  return n;
+}
+
+SNPRINTF_API int mmap_sink_printf(struct mmap_sink *ms, const char *format,
+    ...) {
+  int rval;
+  va_list args;
+
+  va_start(args, format);
+  rval = mmap_sink_vprintf(ms, format, args);
+  va_end(args);
+
+  return rval;
+}
+
+SNPRINTF_API int mmap_sink_close(struct mmap_sink *ms) {
+  int rval = 0;
+
+  if (ms->base != NULL && munmap(ms->base, ms->mapped) != 0) {
+    rval = -1;
+  }
+  if (ms->fd >= 0) {
+    if (ftruncate(ms->fd, (off_t)ms->position) != 0) {
+      rval = -1;
+    }
+    if (close(ms->fd) != 0) {
+      rval = -1;
+    }
+  }
+
+  ms->base = NULL;
+  ms->mapped = 0;
+  ms->fd = -1;
+  return rval;
+}
+#endif
+
+
+#ifdef SNPRINTF_SCAN
+/** Is @p c white space character (the same as isspace() in "C" locale)? */
+#define IS_SPACE(c)           ((c) == ' ' || (unsigned char)((c) - '\t') < 5)
+
+/** Value of digit character (bases up to 36) increased by 1, 0 for others. */
+static const unsigned char digit_values[256] = {
+  ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5, ['5'] = 6, ['6'] = 7,
+  ['7'] = 8, ['8'] = 9, ['9'] = 10, ['a'] = 11, ['b'] = 12, ['c'] = 13,
+  ['d'] = 14, ['e'] = 15, ['f'] = 16, ['g'] = 17, ['h'] = 18, ['i'] = 19,
+  ['j'] = 20, ['k'] = 21, ['l'] = 22, ['m'] = 23, ['n'] = 24, ['o'] = 25,
+  ['p'] = 26, ['q'] = 27, ['r'] = 28, ['s'] = 29, ['t'] = 30, ['u'] = 31,
+  ['v'] = 32, ['w'] = 33, ['x'] = 34, ['y'] = 35, ['z'] = 36, ['A'] = 11,
+  ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16, ['G'] = 17,
+  ['H'] = 18, ['I'] = 19, ['J'] = 20, ['K'] = 21, ['L'] = 22, ['M'] = 23,
+  ['N'] = 24, ['O'] = 25, ['P'] = 26, ['Q'] = 27, ['R'] = 28, ['S'] = 29,
+  ['T'] = 30, ['U'] = 31, ['V'] = 32, ['W'] = 33, ['X'] = 34, ['Y'] = 35,
+  ['Z'] = 36
+};
+
+/** Value of @p c digit character (UINT_MAX for not digit character). */
+#define DIGIT_VALUE(c)        ((unsigned int)digit_values[(unsigned char)(c)] - 1u)
+
+/** Bits of positive infinity (IEEE-754 double). */
+#define INF_BITS              0x7ff0000000000000ull
+/** Bits of quiet not a number (IEEE-754 double). */
+#define NAN_BITS              0x7ff8000000000000ull
+
+/** The largest value of "long long" integer. */
+#define LL_MAX                ((long long)(~0ull >> 1))
+
+/** The largest exponent kept by parser (larger ones give the same result). */
+#define MAX_SCAN_EXPONENT     100000
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/** Decimal digits are parsed by 8 at once (SWAR - SIMD within register). */
+#define SWAR_DIGITS
+
+/** Load 8 characters of @p p to word (the first character in low byte). */
+static unsigned long long load_8(const char *p) {
+  unsigned long long v;
+
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/** Are all 8 characters in @p v word decimal digits? */
+static int is_8_digits(unsigned long long v) {
+  return ((v & 0xf0f0f0f0f0f0f0f0ull) |
+      (((v + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) ==
+      0x3333333333333333ull;
+}
+
+/** Value of 8 decimal digits in @p v word - pairs, quads, then all 8. */
+static unsigned long long value_8_digits(unsigned long long v) {
+  v = ((v & 0x0f0f0f0f0f0f0f0full) * 2561) >> 8;
+  v = ((v & 0x00ff00ff00ff00ffull) * 6553601) >> 16;
+  return ((v & 0x0000ffff0000ffffull) * 42949672960001ull) >> 32;
+}
+#endif
+
+/** Skip decimal digits of string from @p p to @p e. */
+static const char *skip_digits(const char *p, const char *e) {
+#ifdef SWAR_DIGITS
+  while (e - p >= 8 && is_8_digits(load_8(p))) {
+    p += 8;
+  }
+#endif
+  while (p < e && (unsigned int)(*p - '0') < 10) {
+    p++;
+  }
+
+  return p;
+}
+
+/** Append @p n decimal digits at @p p to @p w number (result must fit). */
+static unsigned long long digits_value(unsigned long long w, const char *p,
+    size_t n) {
+#ifdef SWAR_DIGITS
+  for (; n >= 8; p += 8, n -= 8) {
+    w = w * 100000000 + value_8_digits(load_8(p));
+  }
+#endif
+  for (; n > 0; p++, n--) {
+    w = w * 10 + (unsigned int)(*p - '0');
+  }
+
+  return w;
+}
+
+/**
+ * Parse digits of @p base from @p p to @p e into @p value. On overflow
+ * digits are still skipped and @p overflow is set.
+ *
+ * @return Pointer just after the last digit.
+ */
+static const char *scan_digits(const char *p, const char *e, unsigned int base,
+    unsigned long long *value, int *overflow) {
+  unsigned long long w = 0, limit = ~0ull / base;
+  unsigned int digit, last = (unsigned int)(~0ull % base);
+
+#ifdef SWAR_DIGITS
+  if (base == 10) { /* 8 digits at once while the next 8 surely fit */
+    for (; e - p >= 8 && w <= 184467440736ull && is_8_digits(load_8(p));
+        p += 8) {
+      w = w * 100000000 + value_8_digits(load_8(p));
+    }
+  }
+#endif
+  for (; p < e && (digit = DIGIT_VALUE(*p)) < base; p++) {
+    if (w < limit || (w == limit && digit <= last)) {
+      w = w * base + digit;
+    } else {
+      *overflow = 1;
+    }
+  }
+
+  *value = w;
+  return p;
+}
 
-          case 'e':
-          case 'E': { /* scientific (exponential) floating point */
-            double d;
-            DOUBLE_ARG(&data, d);
-            exponent(&data, d);
-            is_continue = 0;
-            break;
-          }
+/**
+ * Parse integer like strtoull(): white spaces, sign, prefix ("0x" or "0b"
+ * for @p base 16, 2 or 0, "0" for octal with @p base 0) and digits.
+ *
+ * @return Pointer just after the number (@p str if there is no number).
+ */
+static const char *scan_integer(const char *str, const char *e, int base,
+    int *is_negative, unsigned long long *value, int *overflow) {
+  const char *p = str, *digits;
 
-          case 'g':
-          case 'G': { /* scientific or decimal floating point */
-            int log;
-            double d;
-            DOUBLE_ARG(&data, d);
-            log = log_10(d);
-            /* use decimal floating point (%f / %F) if exponent is in the range
-               [-4,precision] exclusively else use scientific floating
-               point (%e / %E) */
-            if (-4 < log && log < data.precision) {
-              floating(&data, d);
-            } else {
-              exponent(&data, d);
-            }
-            is_continue = 0;
-            break;
-          }
+  *is_negative = 0;
+  *value = 0;
+  *overflow = 0;
 
-          case 'u': { /* unsigned decimal integer */
-            long long ll;
-            INTEGER_ARG(&data, unsigned, ll);
-            decimal(&data, ll);
-            is_continue = 0;
-            break;
-          }
+  if (base < 0 || base == 1 || base > 36) {
+    errno = EINVAL;
+    return str;
+  }
 
-          case 'i':
-          case 'd': { /* signed decimal integer */
-            long long ll;
-            INTEGER_ARG(&data, signed, ll);
-            decimal(&data, ll);
-            is_continue = 0;
-            break;
-          }
+  while (p < e && IS_SPACE(*p)) {
+    p++;
+  }
+  if (p < e && (*p == '-' || *p == '+')) {
+    *is_negative = *p++ == '-';
+  }
 
-          case 'o': { /* octal (always unsigned) */
-            long long ll;
-            INTEGER_ARG(&data, unsigned, ll);
-            octal(&data, ll);
-            is_continue = 0;
-            break;
-          }
+  if (e - p >= 3 && p[0] == '0') { /* prefix only when digit follows it */
+    char x = (char)(p[1] | 0x20);
+    if (x == 'x' && (base == 0 || base == 16) && DIGIT_VALUE(p[2]) < 16) {
+      base = 16;
+      p += 2;
+    } else if (x == 'b' && (base == 0 || base == 2) && DIGIT_VALUE(p[2]) < 2) {
+      base = 2;
+      p += 2;
+    }
+  }
+  if (base == 0) {
+    base = p < e && *p == '0' ? 8 : 10;
+  }
 
-          case 'x':
-          case 'X': { /* hexadecimal (always unsigned) */
-            long long ll;
-            INTEGER_ARG(&data, unsigned, ll);
-            hex(&data, ll);
-            is_continue = 0;
-            break;
-          }
+  digits = p;
+  p = scan_digits(p, e, (unsigned int)base, value, overflow);
 
-          case 'c': { /* single character */
-            int i = va_arg(args, int);
-            PUT_CHAR((char)i, &data);
-            is_continue = 0;
-            break;
-          }
+  return p == digits ? str : p;
+}
 
-          case 's': /* string of characters */
-            WIDTH_AND_PRECISION_ARGS(&data);
-            strings(&data, va_arg(args, char *));
-            is_continue = 0;
-            break;
-
-          case 'p': { /* pointer */
-            void *v = va_arg(args, void *);
-            data.is_square = 1;
-            if (v == NULL) {
-              strings(&data, "(nil)");
-            } else {
-              hex(&data, (long long)v);
-            }
-            is_continue = 0;
-            break;
-          }
+SNPRINTF_API unsigned long long scan_ull(const char *str, size_t len,
+    const char **end, int base) {
+  unsigned long long n;
+  int is_negative, overflow;
+  const char *p = scan_integer(str, str + len, base, &is_negative, &n,
+    &overflow);
 
-          case 'n': /* what's the count ? */
-            *(va_arg(args, int *)) = (int)data.counter;
-            is_continue = 0;
-            break;
-
-          case 'l': /* long or long long */
-            if (data.a_long == INT_LEN_LONG) {
-              data.a_long = INT_LEN_LONG_LONG;
-            } else {
-              data.a_long = INT_LEN_LONG;
-            }
-            break;
-
-          case 'h': /* short or char */
-            if (data.a_long == INT_LEN_SHORT) {
-              data.a_long = INT_LEN_CHAR;
-            } else {
-              data.a_long = INT_LEN_SHORT;
-            }
-            break;
-
-          case '%': /* nothing just % */
-            PUT_CHAR('%', &data);
-            is_continue = 0;
-            break;
-
-          case '#':
-          case ' ':
-          case '+':
-          case '*':
-          case '-':
-          case '.':
-          case '0':
-          case '1':
-          case '2':
-          case '3':
-          case '4':
-          case '5':
-          case '6':
-          case '7':
-          case '8':
-          case '9':
-            conv_flags(&data);
-            break;
-
-          default:
-            /* is this an error ? maybe bail out */
-            PUT_CHAR('%', &data);
-            is_continue = 0;
-            break;
-        } /* end switch */
-      } /* end of while */
-    } else { /* not % */
-      PUT_CHAR(*data.pf, &data); /* add the char the string */
+  if (end != NULL) {
+    *end = p;
+  }
+
+  if (overflow) {
+    errno = ERANGE;
+    return ~0ull;
+  }
+
+  return is_negative ? 0ull - n : n;
+}
+
+SNPRINTF_API long long scan_ll(const char *str, size_t len, const char **end,
+    int base) {
+  unsigned long long n;
+  int is_negative, overflow;
+  const char *p = scan_integer(str, str + len, base, &is_negative, &n,
+    &overflow);
+
+  if (end != NULL) {
+    *end = p;
+  }
+
+  if (overflow || n > (unsigned long long)LL_MAX + (unsigned int)is_negative) {
+    errno = ERANGE;
+    return is_negative ? -LL_MAX - 1 : LL_MAX;
+  }
+
+  return is_negative && n != 0 ? -(long long)(n - 1) - 1 : (long long)n;
+}
+
+/**
+ * Parse [+-]digits exponent just after its @p p marker ('e' or 'p').
+ * Exponent is saturated at +/-MAX_SCAN_EXPONENT.
+ *
+ * @return Pointer just after the exponent (@p p if there are no digits).
+ */
+static const char *scan_exponent(const char *p, const char *e,
+    long *exponent) {
+  const char *q = p + 1;
+  int is_negative = 0;
+  long x = 0;
+
+  if (q < e && (*q == '-' || *q == '+')) {
+    is_negative = *q++ == '-';
+  }
+  if (q == e || (unsigned int)(*q - '0') >= 10) {
+    return p;
+  }
+
+  for (; q < e && (unsigned int)(*q - '0') < 10; q++) {
+    if (x < MAX_SCAN_EXPONENT) {
+      x = x * 10 + (*q - '0');
+    }
+  }
+
+  *exponent = is_negative ? -x : x;
+  return q;
+}
+
+/**
+ * Parse hexadecimal floating point number (just after "0x") to bits of
+ * double rounded half to even. There is at least one hexadecimal digit.
+ *
+ * @return Pointer just after the number.
+ */
+static const char *scan_hex_double(const char *p, const char *e,
+    unsigned long long *bits) {
+  unsigned long long m = 0, mantissa, rest, half;
+  long exponent = 0, e2;
+  int is_sticky = 0, is_fraction = 0, shift;
+  unsigned int digit;
+
+  for (; p < e; p++) {
+    if (*p == '.' && !is_fraction) {
+      is_fraction = 1;
+      continue;
+    }
+    if ((digit = DIGIT_VALUE(*p)) >= 16) {
+      break;
+    }
+    if ((m >> 60) == 0) { /* room for the next digit */
+      m = m * 16 + digit;
+      exponent -= is_fraction ? 4 : 0;
+    } else { /* only sticky bit for rounding */
+      is_sticky |= digit != 0;
+      exponent += is_fraction || exponent >= MAX_SCAN_EXPONENT ? 0 : 4;
+    }
+  }
+
+  if (p < e && (*p | 0x20) == 'p') {
+    long x = 0;
+    p = scan_exponent(p, e, &x);
+    exponent += x;
+  }
+
+  if (m == 0) {
+    *bits = 0;
+    return p;
+  }
+
+  /* m * 2^e2 with the highest bit of m set, so number is in [2^e2, 2^(e2+1)) */
+  shift = leading_zeros(m);
+  m <<= shift;
+  e2 = exponent - shift + 63;
+
+  if (e2 > 1023) {
+    errno = ERANGE;
+    *bits = INF_BITS;
+    return p;
+  }
+
+  /* keep 53 bits of normal number, less of subnormal one */
+  shift = e2 >= -1022 ? 11 : 11 - 1022 - (int)(e2 < -1100 ? -1100 : e2);
+  if (shift > 64) {
+    errno = ERANGE;
+    *bits = 0;
+    return p;
+  }
+  mantissa = shift < 64 ? m >> shift : 0;
+  rest = shift < 64 ? m & ((1ull << shift) - 1) : m;
+  half = 1ull << (shift - 1);
+  if (rest > half || (rest == half && (is_sticky || (mantissa & 1)))) {
+    mantissa++; /* carry goes to exponent */
+  }
+
+  *bits = e2 >= -1022 ?
+    ((unsigned long long)(e2 + 1022) << 52) + mantissa : mantissa;
+  if (*bits == 0 || *bits == INF_BITS) {
+    errno = ERANGE;
+  }
+  return p;
+}
+
+#ifndef SNPRINTF_NO_FLOAT
+/**
+ * Eisel-Lemire algorithm - bits of double nearest to @p w * 10^@p q taken
+ * from the highest bits of product of @p w and 128-bit 5^@p q.
+ *
+ * @param w Not 0 decimal significand (exact).
+ * @param q Decimal exponent.
+ */
+static unsigned long long eisel_lemire(unsigned long long w, int q) {
+  unsigned long long low, high, second, mantissa;
+  int lz, upper, shift, power2;
+
+  if (q < POW_5_MIN) {
+    return 0;
+  }
+  if (q > 308) { /* at least 10^309 */
+    return INF_BITS;
+  }
+
+  lz = leading_zeros(w);
+  w <<= lz;
+  low = multiply_64(w, pow_5_128[2 * (q - POW_5_MIN)], &high);
+  if ((high & 0x1ff) == 0x1ff) { /* 55 bits of product could be inexact */
+    multiply_64(w, pow_5_128[2 * (q - POW_5_MIN) + 1], &second);
+    low += second;
+    high += second > low;
+  }
+
+  upper = (int)(high >> 63);
+  shift = upper + 64 - 52 - 3;
+  mantissa = high >> shift;
+  power2 = FLOOR_LOG2_10(q) + 63 + upper - lz + 1023; /* biased exponent */
+
+  if (power2 <= 0) { /* subnormal number */
+    if (1 - power2 >= 64) {
+      return 0;
+    }
+    mantissa >>= 1 - power2;
+    mantissa += mantissa & 1;
+    return mantissa >> 1; /* carry goes to exponent */
+  }
+
+  if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+      (mantissa << shift) == high) { /* exactly halfway - round to even */
+    mantissa &= ~1ull;
+  }
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= 2ull << 52) {
+    mantissa = 1ull << 52;
+    power2++;
+  }
+
+  if (power2 >= 0x7ff) {
+    return INF_BITS;
+  }
+  return ((unsigned long long)power2 << 52) | (mantissa & ((1ull << 52) - 1));
+}
+#endif
+
+/** Maximum amount of digits of DECIMAL (enough for all halfway cases). */
+#define DECIMAL_DIGITS        800
+/** The largest shift of DECIMAL at once (digit << shift fits 64 bits). */
+#define DECIMAL_MAX_SHIFT     60
+
+/** Arbitrary precision decimal number 0.d[0]d[1]...d[nd-1] * 10^dp. */
+struct DECIMAL {
+  unsigned char d[DECIMAL_DIGITS + 19]; /**< digits, room for left shift */
+  int nd;                     /**< amount of digits in DECIMAL::d */
+  int dp;                     /**< decimal point position */
+  int trunc;                  /**< not 0 digits were dropped after DECIMAL::d */
+};
+
+/** Remove trailing zeros of @p a. */
+static void decimal_trim(struct DECIMAL *a) {
+  while (a->nd > 0 && a->d[a->nd - 1] == 0) {
+    a->nd--;
+  }
+  if (a->nd == 0) {
+    a->dp = 0;
+  }
+}
+
+/** Multiply @p a by 2^@p k (from the least significant digit). */
+static void decimal_left_shift(struct DECIMAL *a, int k) {
+  unsigned long long n = 0;
+  int r, w = a->nd + 19, nd;
+
+  for (r = a->nd - 1; r >= 0 || n != 0; r--) {
+    if (r >= 0) {
+      n += (unsigned long long)a->d[r] << k;
+    }
+    a->d[--w] = (unsigned char)(n % 10);
+    n /= 10;
+  }
+
+  nd = a->nd + 19 - w;
+  memmove(a->d, a->d + w, (size_t)nd);
+  a->dp += nd - a->nd;
+  for (a->nd = nd; a->nd > DECIMAL_DIGITS; a->nd--) {
+    a->trunc |= a->d[a->nd - 1] != 0;
+  }
+  decimal_trim(a);
+}
+
+/** Divide @p a by 2^@p k (from the most significant digit). */
+static void decimal_right_shift(struct DECIMAL *a, int k) {
+  unsigned long long n = 0, mask = (1ull << k) - 1;
+  int r = 0, w = 0;
+
+  for (; (n >> k) == 0; r++) { /* enough digits for the first one */
+    if (r >= a->nd) {
+      if (n == 0) {
+        a->nd = 0;
+        return;
+      }
+      for (; (n >> k) == 0; r++) {
+        n *= 10;
+      }
+      break;
+    }
+    n = n * 10 + a->d[r];
+  }
+  a->dp -= r - 1;
+
+  for (; r < a->nd; r++) {
+    unsigned char digit = a->d[r];
+    a->d[w++] = (unsigned char)(n >> k);
+    n = (n & mask) * 10 + digit;
+  }
+  for (; n != 0; n = (n & mask) * 10) {
+    if (w < DECIMAL_DIGITS) {
+      a->d[w++] = (unsigned char)(n >> k);
+    } else {
+      a->trunc |= (n >> k) != 0;
+    }
+  }
+
+  a->nd = w;
+  decimal_trim(a);
+}
+
+/** Multiply @p a by 2^@p k (@p k could be negative). */
+static void decimal_shift(struct DECIMAL *a, int k) {
+  if (a->nd == 0) {
+    return;
+  }
+
+  for (; k > DECIMAL_MAX_SHIFT; k -= DECIMAL_MAX_SHIFT) {
+    decimal_left_shift(a, DECIMAL_MAX_SHIFT);
+  }
+  for (; k < -DECIMAL_MAX_SHIFT; k += DECIMAL_MAX_SHIFT) {
+    decimal_right_shift(a, DECIMAL_MAX_SHIFT);
+  }
+
+  if (k > 0) {
+    decimal_left_shift(a, k);
+  } else if (k < 0) {
+    decimal_right_shift(a, -k);
+  }
+}
+
+/** Should @p a be rounded up when it is cut to @p nd digits (half to even)? */
+static int decimal_round_up(const struct DECIMAL *a, int nd) {
+  if (nd < 0 || nd >= a->nd) {
+    return 0;
+  }
+  if (a->d[nd] == 5 && nd + 1 == a->nd) { /* exactly halfway? */
+    return a->trunc || (nd > 0 && a->d[nd - 1] % 2 == 1);
+  }
+  return a->d[nd] >= 5;
+}
+
+/** Integral part of @p a rounded half to even (at most 20 digits). */
+static unsigned long long decimal_integer(const struct DECIMAL *a) {
+  unsigned long long n = 0;
+  int i;
+
+  for (i = 0; i < a->dp && i < a->nd; i++) {
+    n = n * 10 + a->d[i];
+  }
+  for (; i < a->dp; i++) {
+    n *= 10;
+  }
+
+  return n + (unsigned long long)decimal_round_up(a, a->dp);
+}
+
+/**
+ * Bits of double nearest to decimal number of any length - digits (with
+ * optional '.') from @p p to @p e and decimal @p exponent. Number is
+ * scaled by powers of 2 in arbitrary precision to [0.5, 1) and then to 53
+ * bits of integer, so it is slow, but exact.
+ */
+static unsigned long long decimal_bits(const char *p, const char *e,
+    long exponent) {
+  static const unsigned char powers[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+  struct DECIMAL a;
+  unsigned long long mantissa;
+  long dp = 0;
+  int is_fraction = 0, n, e2 = 0;
+
+  a.nd = 0;
+  a.trunc = 0;
+  for (; p < e; p++) {
+    if (*p == '.') {
+      is_fraction = 1;
+    } else if (*p == '0' && a.nd == 0) { /* leading zeros */
+      dp -= is_fraction;
+    } else {
+      dp += !is_fraction;
+      if (a.nd < DECIMAL_DIGITS) {
+        a.d[a.nd++] = (unsigned char)(*p - '0');
+      } else {
+        a.trunc |= *p != '0';
+      }
+    }
+  }
+  dp += exponent;
+  decimal_trim(&a);
+
+  if (a.nd == 0 || dp < -330) {
+    return 0;
+  }
+  if (dp > 310) {
+    return INF_BITS;
+  }
+  a.dp = (int)dp;
+
+  /* scale to [0.5, 1) */
+  for (; a.dp > 0; e2 += n) {
+    n = a.dp >= (int)sizeof(powers) ? 27 : powers[a.dp];
+    decimal_shift(&a, -n);
+  }
+  for (; a.dp < 0 || (a.dp == 0 && a.d[0] < 5); e2 -= n) {
+    n = -a.dp >= (int)sizeof(powers) ? 27 : powers[-a.dp];
+    decimal_shift(&a, n);
+  }
+  e2--; /* number is in [1, 2) * 2^e2 */
+
+  if (e2 < -1022) { /* subnormal number */
+    n = -1022 - e2;
+    decimal_shift(&a, -n);
+    e2 += n;
+  }
+  if (e2 + 1023 >= 0x7ff) {
+    return INF_BITS;
+  }
+
+  decimal_shift(&a, 53);
+  mantissa = decimal_integer(&a);
+  if (mantissa == 2ull << 52) { /* carry of rounding */
+    mantissa >>= 1;
+    if (++e2 + 1023 >= 0x7ff) {
+      return INF_BITS;
+    }
+  }
+  if ((mantissa & (1ull << 52)) == 0) {
+    e2 = -1023;
+  }
+
+  return ((unsigned long long)(e2 + 1023) << 52) |
+    (mantissa & ((1ull << 52) - 1));
+}
+
+/** Is there other digit than '0' from @p p to @p e? */
+static int has_not_zero(const char *p, const char *e) {
+  for (; p < e; p++) {
+    if (*p != '0') {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Bits of double nearest to decimal number - integral digits from @p ip to
+ * @p ie, fraction digits from @p fp to @p fe and decimal @p exponent. Up to
+ * 19 significant digits are taken to one word. Exact words of up to 2^53
+ * and small exponent are scaled by exact power of 10 (pow_10()), others by
+ * Eisel-Lemire algorithm. If there are more not zero digits, result is
+ * taken only when the word and the word + 1 give the same one, otherwise
+ * decimal_bits() decides.
+ */
+static unsigned long long scan_decimal(const char *ip, const char *ie,
+    const char *fp, const char *fe, long exponent) {
+  const char *p = ip, *f = fp;
+  unsigned long long w, bits;
+  size_t ni, nf, ki, kf;
+  long q;
+  int is_truncated;
+
+  while (p < ie && *p == '0') { /* leading zeros are not significant */
+    p++;
+  }
+  if (p == ie) {
+    while (f < fe && *f == '0') {
+      f++;
+    }
+  }
+
+  ni = (size_t)(ie - p);
+  nf = (size_t)(fe - f);
+  if (ni + nf == 0) {
+    return 0;
+  }
+
+  ki = ni < 19 ? ni : 19;
+  kf = nf < 19 - ki ? nf : 19 - ki;
+  w = digits_value(digits_value(0, p, ki), f, kf);
+  q = exponent + (long)(ni - ki) - (long)(kf + (size_t)(f - fp));
+  is_truncated = ki < ni ?
+    has_not_zero(p + ki, ie) || has_not_zero(fp, fe) :
+    has_not_zero(f + kf, fe);
+
+#ifndef SNPRINTF_NO_FLOAT
+  if (!is_truncated && w <= 1ull << 53 && q >= -22 && q <= 22) {
+    /* w and 10^|q| are exact, so only one rounding */
+    double d = q < 0 ? (double)w / pow_10((int)-q) : (double)w * pow_10((int)q);
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+  }
+
+  bits = eisel_lemire(w, q < POW_5_MIN ? POW_5_MIN - 1 :
+    q > POW_5_MAX ? POW_5_MAX + 1 : (int)q);
+  if (is_truncated && bits != eisel_lemire(w + 1, q < POW_5_MIN ?
+      POW_5_MIN - 1 : q > POW_5_MAX ? POW_5_MAX + 1 : (int)q)) {
+    bits = decimal_bits(p, fe, exponent);
+  }
+#else
+  (void)w;
+  (void)q;
+  (void)is_truncated;
+  bits = decimal_bits(p, fe, exponent);
+#endif
+
+  if (bits == 0 || bits == INF_BITS) {
+    errno = ERANGE;
+  }
+  return bits;
+}
+
+/** Length of @p word (lower case letters) at @p p to @p e (any case) or 0. */
+static size_t match_word(const char *p, const char *e, const char *word) {
+  size_t n = 0;
+
+  for (; word[n] != '\0'; n++) {
+    if (p + n == e || (p[n] | 0x20) != word[n]) {
+      return 0;
+    }
+  }
+
+  return n;
+}
+
+SNPRINTF_API double scan_double(const char *str, size_t len,
+    const char **end) {
+  const char *p = str, *e = str + len, *ip, *ie, *fp, *fe;
+  unsigned long long bits;
+  long exponent = 0;
+  int is_negative = 0;
+  size_t n;
+  double d;
+
+  while (p < e && IS_SPACE(*p)) {
+    p++;
+  }
+  if (p < e && (*p == '-' || *p == '+')) {
+    is_negative = *p++ == '-';
+  }
+
+  if ((n = match_word(p, e, "inf")) != 0) {
+    bits = INF_BITS;
+    p += n;
+    p += match_word(p, e, "inity");
+  } else if ((n = match_word(p, e, "nan")) != 0) {
+    bits = NAN_BITS;
+    p += n;
+    if (p < e && *p == '(') { /* nan(n-char-sequence) */
+      const char *q = p + 1;
+      while (q < e && (DIGIT_VALUE(*q) < 36 || *q == '_')) {
+        q++;
+      }
+      p = q < e && *q == ')' ? q + 1 : p;
     }
+  } else if (e - p >= 3 && p[0] == '0' && (p[1] | 0x20) == 'x' &&
+      (DIGIT_VALUE(p[2]) < 16 ||
+        (p[2] == '.' && e - p >= 4 && DIGIT_VALUE(p[3]) < 16))) {
+    p = scan_hex_double(p + 2, e, &bits);
+  } else {
+    ip = p;
+    ie = skip_digits(ip, e);
+    fp = fe = ie;
+    if (ie < e && *ie == '.') {
+      fp = ie + 1;
+      fe = skip_digits(fp, e);
+    }
+    if (ie == ip && fe == fp) { /* no digits */
+      if (end != NULL) {
+        *end = str;
+      }
+      return 0.;
+    }
+
+    p = fe;
+    if (p < e && (*p | 0x20) == 'e') {
+      p = scan_exponent(p, e, &exponent);
+    }
+    bits = scan_decimal(ip, ie, fp, fe, exponent);
+  }
+
+  if (end != NULL) {
+    *end = p;
   }
 
-  if (data.ps != NULL) {
-    *data.ps = '\0'; /* the end ye ! */
+  bits |= (unsigned long long)is_negative << 63;
+  memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+/** Store @p value to the next argument - pointer to integer of @p length. */
+static void store_integer(va_list *ap, int length, unsigned long long value) {
+  switch (length) {
+    case INT_LEN_CHAR:
+      *va_arg(*ap, signed char *) = (signed char)value;
+      break;
+    case INT_LEN_SHORT:
+      *va_arg(*ap, short *) = (short)value;
+      break;
+    case INT_LEN_LONG:
+      *va_arg(*ap, long *) = (long)value;
+      break;
+    case INT_LEN_LONG_LONG:
+      *va_arg(*ap, long long *) = (long long)value;
+      break;
+    default:
+      *va_arg(*ap, int *) = (int)value;
+      break;
+  }
+}
+
+/** Failure of sscan() - input ends before conversion. */
+#define INPUT_FAILURE         -1
+/** Failure of sscan() - input does not match format. */
+#define MATCHING_FAILURE      1
+
+SNPRINTF_API int vsscan(const char *str, const char *format, va_list args) {
+  const char *p = str, *e = str + strlen(str), *f, *next, *limit;
+  int assigned = 0, failure = 0, width, length, is_suppressed;
+  va_list ap;
+
+  va_copy(ap, args);
+  for (f = format; failure == 0 && *f != '\0'; f++) {
+    if (IS_SPACE(*f)) { /* any amount of white spaces (also none) */
+      while (p < e && IS_SPACE(*p)) {
+        p++;
+      }
+      continue;
+    }
+
+    if (*f != '%' || f[1] == '%') { /* literal character */
+      if (*f == '%') {
+        f++;
+        while (p < e && IS_SPACE(*p)) {
+          p++;
+        }
+      }
+      if (p == e) {
+        failure = INPUT_FAILURE;
+      } else if (*p != *f) {
+        failure = MATCHING_FAILURE;
+      } else {
+        p++;
+      }
+      continue;
+    }
+
+    is_suppressed = *++f == '*';
+    f = parse_int(f + is_suppressed, &width);
+    length = INT_LEN_DEFAULT;
+    for (; *f == 'l' || *f == 'h'; f++) {
+      if (*f == 'l') { /* long or long long */
+        length = length == INT_LEN_LONG ? INT_LEN_LONG_LONG : INT_LEN_LONG;
+      } else { /* short or char */
+        length = length == INT_LEN_SHORT ? INT_LEN_CHAR : INT_LEN_SHORT;
+      }
+    }
+
+    if (*f == 'n') { /* amount of parsed characters, not an assignment */
+      if (!is_suppressed) {
+        store_integer(&ap, length, (unsigned long long)(p - str));
+      }
+      continue;
+    }
+
+    if (*f != 'c') {
+      while (p < e && IS_SPACE(*p)) {
+        p++;
+      }
+    }
+    if (p == e) {
+      failure = INPUT_FAILURE;
+      continue;
+    }
+    limit = width > 0 && width < e - p ? p + width : e;
+
+    switch (*f) {
+      case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': {
+        int base = *f == 'i' ? 0 : *f == 'o' ? 8 : *f == 'x' || *f == 'X' ?
+          16 : 10;
+        unsigned long long value = *f == 'd' || *f == 'i' ?
+          (unsigned long long)scan_ll(p, (size_t)(limit - p), &next, base) :
+          scan_ull(p, (size_t)(limit - p), &next, base);
+        if (next != p && !is_suppressed) {
+          store_integer(&ap, length, value);
+        }
+        break;
+      }
+#ifndef SNPRINTF_NO_FLOAT
+      case 'a': case 'A': case 'e': case 'E': case 'f': case 'F': case 'g':
+      case 'G': {
+        double d = scan_double(p, (size_t)(limit - p), &next);
+        if (next != p && !is_suppressed) {
+          if (length == INT_LEN_LONG) {
+            *va_arg(ap, double *) = d;
+          } else {
+            *va_arg(ap, float *) = (float)d;
+          }
+        }
+        break;
+      }
+#endif
+      case 's':
+        next = p;
+        while (next < limit && !IS_SPACE(*next)) {
+          next++;
+        }
+        if (!is_suppressed) {
+          char *s = va_arg(ap, char *);
+          memcpy(s, p, (size_t)(next - p));
+          s[next - p] = '\0';
+        }
+        break;
+      case 'c': /* exactly width characters (less at the end of input) */
+        next = width > 0 ? limit : p + 1;
+        if (!is_suppressed) {
+          memcpy(va_arg(ap, char *), p, (size_t)(next - p));
+        }
+        break;
+      default: /* unsupported conversion */
+        next = p;
+        break;
+    }
+
+    if (next == p) {
+      failure = MATCHING_FAILURE;
+    } else {
+      assigned += !is_suppressed;
+      p = next;
+    }
   }
+  va_end(ap);
 
-  return (int)data.counter;
+  return failure == INPUT_FAILURE && assigned == 0 ? -1 : assigned;
 }
 
-int snprintf(char *string, size_t length, const char *format, ...) {
+SNPRINTF_API int sscan(const char *str, const char *format, ...) {
   int rval;
   va_list args;
 
   va_start(args, format);
-  rval = vsnprintf(string, length, format, args);
+  rval = vsscan(str, format, args);
   va_end(args);
 
   return rval;
 }
-
+#endif
 
 #ifdef __clang__
 #pragma clang diagnostic pop